@@ -0,0 +1,244 @@
+#include "Batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+struct FileListing {
+	string out;
+	string err;
+	bool failed;
+	bool done;
+};
+
+struct WorkQueue {
+	mutex lock;
+	deque<size_t> files;
+};
+
+struct Batch {
+	const vector<string> &files;
+	vector<FileListing> listings;
+	vector<WorkQueue> queues;
+	mutex lock;
+	condition_variable changed;
+	size_t printed; // listings [0, printed) are out; guarded by lock
+	size_t failures;
+
+	Batch(const vector<string> &f, int threads)
+		: files(f), listings(f.size()), queues(threads), printed(0), failures(0) {}
+};
+
+//----------------------------------------------------------------------
+// 							expandInputs
+//----------------------------------------------------------------------
+vector<string> expandInputs(const vector<string> &inputs) {
+	vector<string> files;
+	for (const string &input : inputs) {
+		error_code ec;
+		if (input.size() > 1 && input[0] == '@') {
+			ifstream list(input.substr(1).c_str());
+			string name;
+			while (getline(list, name)) {
+				if (!name.empty()) {
+					files.push_back(name);
+				}
+			}
+		}
+		else if (fs::is_directory(input, ec)) {
+			vector<string> found;
+			for (fs::recursive_directory_iterator it(input, ec), end; it != end; it.increment(ec)) {
+				if (it->is_regular_file(ec) && it->path().extension() == SOURCE_EXTENSION) {
+					found.push_back(it->path().string());
+				}
+			}
+			sort(found.begin(), found.end());
+			files.insert(files.end(), found.begin(), found.end());
+		}
+		else {
+			files.push_back(input);
+		}
+	}
+	return files;
+}
+
+//----------------------------------------------------------------------
+// 							takeFile
+//----------------------------------------------------------------------
+// Pops the next file from worker self's own queue, or steals one from
+// another worker's: its last, or its first if the last is not below
+// limit. Only files below limit are taken. Returns false if there is
+// none; later then says whether files at or past limit are left.
+//----------------------------------------------------------------------
+static bool takeFile(Batch &batch, size_t self, size_t limit, size_t &file, bool &later) {
+	size_t n = batch.queues.size();
+	later = false;
+	for (size_t k = 0; k < n; k++) {
+		WorkQueue &q = batch.queues[(self + k) % n];
+		lock_guard<mutex> guard(q.lock);
+		if (q.files.empty()) {
+			continue;
+		}
+		if (k > 0 && q.files.back() < limit) {
+			file = q.files.back();
+			q.files.pop_back();
+			return true;
+		}
+		if (q.files.front() < limit) {
+			file = q.files.front();
+			q.files.pop_front();
+			return true;
+		}
+		later = true;
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------
+// 							firstWaiting
+//----------------------------------------------------------------------
+// The lowest file no worker has taken yet, or files.size(). Queues are
+// in file order, so it is the least of their fronts.
+//----------------------------------------------------------------------
+static size_t firstWaiting(Batch &batch) {
+	size_t first = batch.files.size();
+	for (WorkQueue &q : batch.queues) {
+		lock_guard<mutex> guard(q.lock);
+		if (!q.files.empty()) {
+			first = min(first, q.files.front());
+		}
+	}
+	return first;
+}
+
+//----------------------------------------------------------------------
+// 							lexWorker
+//----------------------------------------------------------------------
+// Takes files below LISTINGS_AHEAD past the next one to print, waiting
+// for the printer when only later files are left. The next one to
+// print is always below that limit, so some worker can take it or is
+// lexing it.
+//----------------------------------------------------------------------
+static void lexWorker(Batch &batch, size_t self) {
+	LexAnalyzer lex;
+	OutputWriter out(MEMORY_ONLY), err(MEMORY_ONLY);
+	size_t file;
+	while (true) {
+		size_t printed;
+		{
+			lock_guard<mutex> guard(batch.lock);
+			printed = batch.printed;
+		}
+		bool later;
+		if (!takeFile(batch, self, printed + LISTINGS_AHEAD, file, later)) {
+			if (!later) {
+				break;
+			}
+			unique_lock<mutex> guard(batch.lock);
+			batch.changed.wait(guard, [&]() { return batch.printed != printed; });
+			continue;
+		}
+		FileListing &listing = batch.listings[file];
+		out.clear();
+		err.clear();
+		if (lex.open(batch.files[file])) {
+			listing.failed = lex.analyze(out, err) == LexError::unrecognizedChar;
+		}
+		else {
+			err.write("File read error\n");
+			listing.failed = true;
+		}
+		listing.out.assign(out.contents());
+		listing.err.assign(err.contents());
+		lock_guard<mutex> guard(batch.lock);
+		listing.done = true;
+		batch.changed.notify_all();
+	}
+}
+
+//----------------------------------------------------------------------
+// 							prefetchFiles
+//----------------------------------------------------------------------
+// Stays up to PREFETCH_AHEAD files ahead of the first one no worker has
+// taken, skipping those taken already. A worker takes a file before it
+// reports one done, so the wakeup for each report sees the queues moved.
+//----------------------------------------------------------------------
+static void prefetchFiles(Batch &batch) {
+	for (size_t i = 0; i < batch.files.size(); i++) {
+		size_t first;
+		{
+			unique_lock<mutex> guard(batch.lock);
+			batch.changed.wait(guard, [&]() {
+				first = firstWaiting(batch);
+				return i < first + PREFETCH_AHEAD;
+			});
+		}
+		if (i < first) {
+			i = first - 1;
+			continue;
+		}
+		InputBuffer::prefetch(batch.files[i]);
+	}
+}
+
+//----------------------------------------------------------------------
+// 							lexFiles
+//----------------------------------------------------------------------
+// The calling thread prints listings as soon as they are next in line.
+//----------------------------------------------------------------------
+size_t lexFiles(const vector<string> &files, int threads) {
+	threads = max(1, threads);
+	Batch batch(files, threads);
+	for (size_t i = 0; i < files.size(); i++) {
+		batch.listings[i].failed = false;
+		batch.listings[i].done = false;
+		batch.queues[i % threads].files.push_back(i);
+	}
+	thread prefetcher(prefetchFiles, ref(batch));
+	vector<thread> workers;
+	for (int t = 0; t < threads; t++) {
+		workers.emplace_back(lexWorker, ref(batch), t);
+	}
+
+	for (size_t i = 0; i < files.size(); i++) {
+		FileListing &listing = batch.listings[i];
+		{
+			unique_lock<mutex> guard(batch.lock);
+			batch.changed.wait(guard, [&]() { return listing.done; });
+		}
+		standardOutput.write("==> ");
+		standardOutput.write(files[i]);
+		standardOutput.write(" <==\n");
+		standardOutput.write(listing.out);
+		if (!listing.err.empty()) {
+			string_view err = listing.err;
+			while (!err.empty()) {
+				size_t end = min(err.find('\n'), err.size() - 1) + 1;
+				standardError.write(files[i]);
+				standardError.write(": ");
+				standardError.write(err.substr(0, end));
+				err.remove_prefix(end);
+			}
+			standardError.flush();
+		}
+		batch.failures += listing.failed;
+		string().swap(listing.out);
+		string().swap(listing.err);
+		lock_guard<mutex> guard(batch.lock);
+		batch.printed = i + 1;
+		batch.changed.notify_all();
+	}
+	standardOutput.flush();
+
+	prefetcher.join();
+	for (thread &t : workers) {
+		t.join();
+	}
+	return batch.failures;
+}
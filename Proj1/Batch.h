@@ -0,0 +1,29 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "Proj1.h"
+
+const size_t PREFETCH_AHEAD = 64; // files read ahead of the workers
+const size_t LISTINGS_AHEAD = 64; // files lexed ahead of the listing
+constexpr char SOURCE_EXTENSION[] = ".pas";
+
+// Turns command line inputs into a list of files: a directory stands
+// for every SOURCE_EXTENSION file below it, in sorted order, @name for
+// the files named in `name`, one per line, and anything else for
+// itself.
+vector<string> expandInputs(const vector<string> &inputs);
+
+// Lexes every file on `threads` workers, each reusing one LexAnalyzer.
+// Work is dealt out round robin and idle workers steal from the back
+// of the others' queues, while a prefetch thread keeps the next
+// PREFETCH_AHEAD files no worker has taken loading into the page cache.
+// Each listing is collected in memory and printed, under a "==> name
+// <==" header, in the order of files; no file more than LISTINGS_AHEAD
+// past the next one to print is started, which bounds the listings
+// held. Each error line is prefixed with the file's name. A file that
+// cannot be read or stops on an error only affects its own listing.
+// Returns how many files could not be read or hit an unrecognized
+// character.
+size_t lexFiles(const vector<string> &files, int threads);
+
+#endif
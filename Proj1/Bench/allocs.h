@@ -0,0 +1,37 @@
+#ifndef ALLOCS_H
+#define ALLOCS_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+// Replaces the global operator new to count heap allocations and the
+// bytes they hold (liveBytes now, peakBytes at most). Include it in
+// exactly one file of a single-threaded benchmark program.
+static size_t allocations = 0;
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+void *operator new(size_t n) {
+	allocations++;
+	if (void *p = malloc(n)) {
+		liveBytes += malloc_usable_size(p);
+		peakBytes = std::max(peakBytes, liveBytes);
+		return p;
+	}
+	throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+	if (p != NULL) {
+		liveBytes -= malloc_usable_size(p);
+	}
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	operator delete(p);
+}
+
+#endif
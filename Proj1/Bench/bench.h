@@ -0,0 +1,52 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const int BENCH_RUNS = 5;
+
+//----------------------------------------------------------------------
+// 							scaleCorpus
+//----------------------------------------------------------------------
+// writes `times` copies of src to dst and returns dst's size in bytes.
+//----------------------------------------------------------------------
+inline size_t scaleCorpus(const string &src, int times, const string &dst) {
+	ifstream in(src.c_str(), ios::binary);
+	string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	ofstream out(dst.c_str(), ios::binary);
+	for (int i = 0; i < times; i++) {
+		out << text;
+	}
+	return text.size() * times;
+}
+
+//----------------------------------------------------------------------
+// 							medianSeconds
+//----------------------------------------------------------------------
+// runs f once to warm up, then `runs` more times; returns the median.
+//----------------------------------------------------------------------
+template <class F>
+double medianSeconds(int runs, F f) {
+	vector<double> times;
+	f();
+	for (int i = 0; i < runs; i++) {
+		auto start = chrono::steady_clock::now();
+		f();
+		times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+	}
+	sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+inline double megabytesPerSec(size_t bytes, double seconds) {
+	return bytes / seconds / 1e6;
+}
+
+#endif
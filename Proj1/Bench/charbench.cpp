@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------
+// Compares the switch + <cctype> + CC_SYMBOLS scan classifier that
+// categorizeChar used to be against the CHAR_CATEGORIES lookup.
+// usage: charbench [source.pas] [copies]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Proj1.h"
+
+const string LEGACY_SYMBOLS = "+-/[],;^";
+
+bool legacyIssymbol(char c) {
+	for (size_t i = 0; i < LEGACY_SYMBOLS.size(); i++) {
+		if (c == LEGACY_SYMBOLS[i]) return true;
+	}
+	return false;
+}
+
+CharCat legacyCategorize(char c) {
+	CharCat category = CharCat::unknown;
+	switch (c) {
+		case CC_EOL: category = CharCat::eol; break;
+		case CC_EOF: category = CharCat::eof; break;
+		case CC_PERIOD: category = CharCat::period; break;
+		case CC_LEFTPAR: category = CharCat::leftpar; break;
+		case CC_RIGHTPAR: category = CharCat::rightpar; break;
+		case CC_STAR: category = CharCat::star; break;
+		case CC_COLON: category = CharCat::colon; break;
+		case CC_LESSTHAN: category = CharCat::lessthan; break;
+		case CC_GREATTHAN: category = CharCat::greatthan; break;
+		case CC_EQUAL: category = CharCat::equals; break;
+		case CC_QUOTE: category = CharCat::quote;
+	}
+	if (category == CharCat::unknown) {
+		if (isalpha(c)) category = CharCat::alpha;
+		else if (isdigit(c)) category = CharCat::digit;
+		else if (legacyIssymbol(c)) category = CharCat::sym;
+		else if (isspace(c)) category = CharCat::whitespc;
+		else if (c >= CC_MIN && c < CC_MAX) category = CharCat::other;
+		else category = CharCat::invalid;
+	}
+	return category;
+}
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 10000;
+	string path = "/tmp/charbench.pas";
+	size_t bytes = scaleCorpus(src, copies, path);
+	InputBuffer input;
+	if (!input.open(path)) {
+		cerr << "File read error\n";
+		return 1;
+	}
+
+	for (int i = -128; i < 128; i++) {
+		if (legacyCategorize((char)i) != CHAR_CATEGORIES[(char)i]) {
+			cerr << "mismatch on byte " << (i & 0xff) << endl;
+			return 1;
+		}
+	}
+
+	volatile long sink = 0;
+	double tLegacy = medianSeconds(BENCH_RUNS, [&]() {
+		long sum = 0;
+		for (const char *p = input.begin(); p < input.end(); p++) {
+			sum += (int)legacyCategorize(*p);
+		}
+		sink = sum;
+	});
+	double tTable = medianSeconds(BENCH_RUNS, [&]() {
+		long sum = 0;
+		for (const char *p = input.begin(); p < input.end(); p++) {
+			sum += (int)CHAR_CATEGORIES[*p];
+		}
+		sink = sum;
+	});
+
+	cout << fixed << setprecision(2);
+	cout << "input: " << bytes << " bytes, all 256 bytes agree" << endl;
+	cout << "legacy classifier: " << tLegacy * 1e9 / bytes << " ns/char, "
+		<< megabytesPerSec(bytes, tLegacy) << " MB/s" << endl;
+	cout << "table classifier:  " << tTable * 1e9 / bytes << " ns/char, "
+		<< megabytesPerSec(bytes, tTable) << " MB/s" << endl;
+	return 0;
+}
@@ -0,0 +1,147 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Synthetic Pascal source for the benchmarks. Output depends only on
+// the mix, the size and the seed: the generator draws straight from
+// mt19937 (whose sequence is fixed by the standard) and never uses
+// the library distributions, which are not. Everything it writes lexes
+// without errors.
+//----------------------------------------------------------------------
+
+enum class Mix {mixed, identifiers, numbers, comments, literals, symbols};
+
+const char *const MIX_NAMES[] = {"mixed", "identifiers", "numbers", "comments", "literals", "symbols"};
+const int MIX_COUNT = sizeof(MIX_NAMES) / sizeof(MIX_NAMES[0]);
+
+// relative weight of each statement kind, per mix; same order as Mix
+// and the columns are: identifier, number, comment, literal, symbol
+const int MIX_WEIGHTS[MIX_COUNT][5] = {
+	{4, 2, 2, 1, 1},
+	{20, 1, 1, 1, 1},
+	{1, 20, 1, 1, 1},
+	{1, 1, 20, 1, 1},
+	{1, 1, 1, 20, 1},
+	{1, 1, 1, 1, 20},
+};
+
+const char *const NAME_PARTS[] = {"total", "count", "index", "student", "score", "average",
+	"record", "buffer", "Line", "Next", "Grade", "Value", "tmp", "x", "limit", "Offset"};
+const char *const WORDS[] = {"the", "running", "total", "is", "kept", "so", "that", "every",
+	"score", "can", "be", "averaged", "once", "input", "ends", "and", "each", "line", "counts"};
+const char *const OPERATORS[] = {" + ", " - ", " * ", " / ", " div ", " mod "};
+const char *const RELATIONS[] = {" < ", " <= ", " > ", " >= ", " = ", " <> "};
+
+class CorpusGenerator {
+	mt19937 rng;
+	string out;
+
+	template <size_t N>
+	const char *pick(const char *const (&list)[N]) { return list[rng() % N]; }
+
+	void identifier() {
+		int parts = 1 + rng() % 3;
+		for (int i = 0; i < parts; i++) {
+			out += pick(NAME_PARTS);
+		}
+		if (rng() % 2) {
+			out += to_string(rng() % 100);
+		}
+	}
+
+	void number() {
+		out += to_string(rng() % 100000);
+		if (rng() % 3 == 0) {
+			out += '.';
+			out += to_string(rng() % 1000000);
+		}
+	}
+
+	void identifierStatement() {
+		out += '\t';
+		identifier();
+		out += " := ";
+		identifier();
+		for (int terms = rng() % 4; terms > 0; terms--) {
+			out += pick(OPERATORS);
+			identifier();
+		}
+		out += ";\n";
+	}
+
+	void numberStatement() {
+		out += "\tx := ";
+		number();
+		for (int terms = 1 + rng() % 5; terms > 0; terms--) {
+			out += pick(OPERATORS);
+			number();
+		}
+		out += ";\n";
+	}
+
+	void commentStatement() {
+		out += "\t(* ";
+		for (int words = 4 + rng() % 40; words > 0; words--) {
+			out += pick(WORDS);
+			out += rng() % 12 ? " " : "\n\t   ";
+		}
+		out += "*)\n";
+	}
+
+	void literalStatement() {
+		out += "\twriteln('";
+		for (int words = 2 + rng() % 20; words > 0; words--) {
+			out += pick(WORDS);
+			out += rng() % 16 ? " " : "'' ";
+		}
+		out += "', ";
+		identifier();
+		out += ");\n";
+	}
+
+	void symbolStatement() {
+		out += "\tif a[1..";
+		number();
+		out += "]^";
+		out += pick(RELATIONS);
+		out += "b[(i+1)..(j-1)] then c := (d, e);\n";
+	}
+
+public:
+	CorpusGenerator(uint32_t seed) : rng(seed) {}
+
+	string generate(Mix mix, size_t bytes) {
+		const int *weights = MIX_WEIGHTS[(int)mix];
+		int total = 0;
+		for (int k = 0; k < 5; k++) {
+			total += weights[k];
+		}
+		out.clear();
+		out.reserve(bytes + 256);
+		out += "program Generated;\nvar\n\tx : real;\nbegin\n";
+		while (out.size() < bytes) {
+			int r = rng() % total;
+			int kind = 0;
+			while (r >= weights[kind]) {
+				r -= weights[kind++];
+			}
+			switch (kind) {
+				case 0: identifierStatement(); break;
+				case 1: numberStatement(); break;
+				case 2: commentStatement(); break;
+				case 3: literalStatement(); break;
+				default: symbolStatement(); break;
+			}
+		}
+		out += "end.\n";
+		return out;
+	}
+}; // CorpusGenerator
+
+#endif
@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------
+// The table-driven engine (Dfa.h) against LexAnalyzer::tokenize(): each
+// input is first lexed by both and the TokenBuffers compared field by
+// field, then both are timed. Inputs are the generated mixes, or the
+// files named on the command line. Exits 1 if any input differs.
+// usage: dfabench [--mb size] [--seed n] [file...]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "corpus.h"
+#include "../Dfa.h"
+
+#include <cstring>
+#include <iomanip>
+
+//----------------------------------------------------------------------
+// 							sameTokens
+//----------------------------------------------------------------------
+// Describes the first difference between a and b, or returns "".
+//----------------------------------------------------------------------
+static string sameTokens(const TokenBuffer &a, const TokenBuffer &b) {
+	for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+		bool numeric = a.kind[i] == LexCat::integer || a.kind[i] == LexCat::real;
+		if (a.kind[i] != b.kind[i] || a.offset[i] != b.offset[i] || a.length[i] != b.length[i]
+			|| (numeric && memcmp(&a.value[i], &b.value[i], sizeof(TokenValue)) != 0))
+		{
+			return "token " + to_string(i) + " at offset " + to_string(a.offset[i]);
+		}
+	}
+	if (a.size() != b.size()) return "token count";
+	if (a.error != b.error) return "error";
+	if (a.error != LexError::none && a.errorPosition != b.errorPosition) return "error position";
+	if (a.eofToken != b.eofToken) return "end of file token";
+	if (a.eofToken != SIZE_MAX && a.eofOffset != b.eofOffset) return "end of file offset";
+	return "";
+}
+
+//----------------------------------------------------------------------
+// 							compareEngines
+//----------------------------------------------------------------------
+// Checks and times one input; false if the engines disagree.
+//----------------------------------------------------------------------
+static bool compareEngines(const string &name, string_view text) {
+	TokenBuffer expected = LexAnalyzer(text).tokenize();
+	string difference = sameTokens(expected, tokenizeDfa(text));
+	if (!difference.empty()) {
+		cout << setw(16) << name << "  DIFFERENT: " << difference << endl;
+		return false;
+	}
+	double tFsm = medianSeconds(BENCH_RUNS, [&]() {
+		TokenBuffer tokens = LexAnalyzer(text).tokenize();
+	});
+	double tDfa = medianSeconds(BENCH_RUNS, [&]() {
+		TokenBuffer tokens = tokenizeDfa(text);
+	});
+	cout << setw(16) << name << setw(10) << expected.size()
+		<< setw(12) << megabytesPerSec(text.size(), tFsm)
+		<< setw(12) << megabytesPerSec(text.size(), tDfa)
+		<< setw(10) << tFsm / tDfa << "x" << endl;
+	return true;
+}
+
+int main(int argc, char **argv) {
+	double megabytes = 8;
+	uint32_t seed = 441;
+	vector<string> files;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--mb") == 0 && i + 1 < argc) megabytes = atof(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoul(argv[++i], NULL, 10);
+		else files.push_back(argv[i]);
+	}
+
+	cout << fixed << setprecision(1);
+	cout << setw(16) << "input" << setw(10) << "tokens" << setw(12) << "FSM MB/s"
+		<< setw(12) << "DFA MB/s" << setw(11) << "speedup" << endl;
+	bool same = true;
+	if (files.empty()) {
+		for (int m = 0; m < MIX_COUNT; m++) {
+			string text = CorpusGenerator(seed).generate((Mix)m, megabytes * 1e6);
+			same = compareEngines(MIX_NAMES[m], text) && same;
+		}
+	}
+	for (const string &file : files) {
+		InputBuffer input;
+		if (!input.open(file)) {
+			cerr << file << ": cannot read" << endl;
+			return 1;
+		}
+		same = compareEngines(file.substr(file.find_last_of('/') + 1),
+			string_view(input.begin(), input.size())) && same;
+	}
+	return same ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------
+// Pulling tokens through LexAnalyzer::lexemes() against the
+// getNextLexeme() loop and a full tokenize(), on a generated file at
+// two sizes. Each mode feeds the same small consumer; peak heap is what
+// the mode held at most beyond what was live before it started, so the
+// two streaming modes should not grow with the input.
+// usage: genbench [--mb size] [--seed n]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "corpus.h"
+#include "../Proj1.h"
+
+#include "allocs.h"
+
+#include <cstring>
+#include <iomanip>
+
+struct ModeResult {
+	double seconds;
+	size_t peak;
+	long checksum;
+};
+
+//----------------------------------------------------------------------
+// 							measure
+//----------------------------------------------------------------------
+template <class F>
+static ModeResult measure(F f) {
+	ModeResult r;
+	size_t before = liveBytes;
+	peakBytes = liveBytes;
+	r.checksum = f();
+	r.peak = peakBytes - before;
+	r.seconds = medianSeconds(BENCH_RUNS, f);
+	return r;
+}
+
+int main(int argc, char **argv) {
+	double megabytes = 64;
+	uint32_t seed = 441;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--mb") == 0) megabytes = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], NULL, 10);
+	}
+	const char *modes[] = {"tokenize", "pull", "generator"};
+	string path = "/tmp/genbench.pas";
+
+	cout << fixed << setprecision(1);
+	cout << setw(8) << "MB" << setw(12) << "mode" << setw(10) << "MB/s"
+		<< setw(10) << "ns/tok" << setw(16) << "peak heap KiB" << endl;
+	for (double size : {megabytes / 4, megabytes}) {
+		size_t bytes;
+		{
+			string text = CorpusGenerator(seed).generate(Mix::mixed, size * 1e6);
+			bytes = text.size();
+			ofstream(path.c_str(), ios::binary) << text;
+		}
+		ModeResult results[3];
+		results[0] = measure([&]() {
+			LexAnalyzer lex(path);
+			TokenBuffer tokens = lex.tokenize();
+			long sum = 0;
+			for (size_t i = 0; i < tokens.size(); i++) {
+				sum += (int)tokens.kind[i] + tokens.length[i];
+			}
+			return sum;
+		});
+		results[1] = measure([&]() {
+			LexAnalyzer lex(path);
+			long sum = 0;
+			while (!lex.finished()) {
+				Lexeme lexeme = lex.getNextLexeme();
+				if (lexeme.getType() != LexCat::none) {
+					sum += (int)lexeme.getType() + lexeme.getBody().size();
+				}
+			}
+			return sum;
+		});
+		results[2] = measure([&]() {
+			LexAnalyzer lex(path);
+			long sum = 0;
+			for (const Lexeme &lexeme : lex.lexemes()) {
+				sum += (int)lexeme.getType() + lexeme.getBody().size();
+			}
+			return sum;
+		});
+		size_t tokens = LexAnalyzer(path).tokenize().size();
+		for (int m = 0; m < 3; m++) {
+			cout << setw(8) << size << setw(12) << modes[m]
+				<< setw(10) << megabytesPerSec(bytes, results[m].seconds)
+				<< setw(10) << results[m].seconds * 1e9 / tokens
+				<< setw(16) << results[m].peak / 1024.0 << endl;
+		}
+		if (results[1].checksum != results[2].checksum) {
+			cerr << "generator and pull loop disagree" << endl;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------
+// The StringTable hash policies on Proj2's test data, one item per line
+// as Proj2's driver reads it: ns to hash an item, to insert it into a
+// new table and to find it again, and the share of items placed
+// outside their first group. Each timing repeats the whole file until
+// about a million items have gone through.
+// usage: hashbench [file ...]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../../Proj2/proj2.h"
+
+const size_t ITEMS_PER_RUN = 1000000;
+
+vector<string> readItems(const string &path) {
+	vector<string> items;
+	ifstream f(path.c_str());
+	string line;
+	while (!f.eof() && !f.fail()) {
+		getline(f, line);
+		items.push_back(line);
+	}
+	return items;
+}
+
+template <class Hash>
+void measure(const char *name, const vector<string> &items) {
+	size_t repeats = max((size_t)1, ITEMS_PER_RUN / items.size());
+	double perItem = 1e9 / (repeats * items.size());
+	volatile uint64_t sink = 0;
+	double hashNs = medianSeconds(BENCH_RUNS, [&]() {
+		uint64_t x = 0;
+		for (size_t r = 0; r < repeats; r++) {
+			for (const string &item : items) {
+				x += Hash::hash(item);
+			}
+		}
+		sink = x;
+	}) * perItem;
+	double insertNs = medianSeconds(BENCH_RUNS, [&]() {
+		for (size_t r = 0; r < repeats; r++) {
+			BasicStringTable<Hash> table;
+			for (const string &item : items) {
+				table.insert(item);
+			}
+		}
+	}) * perItem;
+	BasicStringTable<Hash> table;
+	for (const string &item : items) {
+		table.insert(item);
+	}
+	double searchNs = medianSeconds(BENCH_RUNS, [&]() {
+		uint64_t found = 0;
+		for (size_t r = 0; r < repeats; r++) {
+			for (const string &item : items) {
+				found += table.search(item) != NULL;
+			}
+		}
+		sink = found;
+	}) * perItem;
+	cout << setw(10) << name << setw(9) << hashNs << setw(9) << insertNs << setw(9) << searchNs
+		<< setw(11) << 100.0 * table.collisions() / table.size() << endl;
+}
+
+int main(int argc, char **argv) {
+	vector<string> paths;
+	for (int i = 1; i < argc; i++) {
+		paths.push_back(argv[i]);
+	}
+	if (paths.empty()) {
+		paths = {"../../Proj2/test.txt", "../../Proj2/test2.txt", "../../Proj2/file.txt"};
+	}
+	cout << fixed << setprecision(1);
+	for (const string &path : paths) {
+		vector<string> items = readItems(path);
+		if (items.empty()) {
+			cerr << path << ": no items" << endl;
+			return 1;
+		}
+		size_t bytes = 0;
+		for (const string &item : items) {
+			bytes += item.size();
+		}
+		cout << path << ": " << items.size() << " items, " << (double)bytes / items.size()
+			<< " bytes on average" << endl;
+		cout << setw(10) << "hash" << setw(9) << "hash" << setw(9) << "insert" << setw(9) << "search"
+			<< setw(11) << "displaced" << "   (ns/item, %)" << endl;
+		measure<LegacyHash>("legacy", items);
+		measure<MurmurHash>("murmur3", items);
+		measure<WideHash>("wide", items);
+	}
+	return 0;
+}
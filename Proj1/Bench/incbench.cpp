@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------
+// Cost of keeping tokens current while a large file is edited: random
+// small edits applied through IncrementalLexer, against re-tokenizing
+// the whole text after each one. Every other edit undoes the one before
+// it so the file does not fill up with scan errors; each incremental
+// result is checked against the full re-lex.
+// usage: incbench [source.pas] [copies] [edits]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Incremental.h"
+
+#include <random>
+
+// snippets that open and close comments, literals and numbers so edits
+// also exercise long re-lexes and resynchronisation
+const char *const EDIT_SNIPPETS[] = {
+	"x", "1", " ", "\n", ".", "'", "(*", "*)", ":=", "12.5", "begin", "''", ";"
+};
+
+//----------------------------------------------------------------------
+// 							median
+//----------------------------------------------------------------------
+template <class T>
+static T median(vector<T> v) {
+	sort(v.begin(), v.end());
+	return v[v.size() / 2];
+}
+
+//----------------------------------------------------------------------
+// 							sameValues
+//----------------------------------------------------------------------
+static bool sameValues(const TokenBuffer &a, const TokenBuffer &b) {
+	for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+		if (a.kind[i] == LexCat::integer && a.value[i].integer != b.value[i].integer) return false;
+		if (a.kind[i] == LexCat::real && a.value[i].real != b.value[i].real) return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------
+// 							sameTokens
+//----------------------------------------------------------------------
+static bool sameTokens(const TokenBuffer &a, const TokenBuffer &b) {
+	return a.kind == b.kind && a.offset == b.offset && a.length == b.length
+		&& sameValues(a, b) && a.error == b.error
+		&& (a.error == LexError::none || a.errorPosition == b.errorPosition)
+		&& a.eofToken == b.eofToken && (a.eofToken == SIZE_MAX || a.eofOffset == b.eofOffset);
+}
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 20000;
+	int edits = argc > 3 ? atoi(argv[3]) : 200;
+	string path = "/tmp/incbench.pas";
+	size_t bytes = scaleCorpus(src, copies, path);
+	ifstream in(path.c_str(), ios::binary);
+	string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+	IncrementalLexer lexer(text);
+	mt19937 rng(441);
+	size_t snippets = sizeof(EDIT_SNIPPETS) / sizeof(EDIT_SNIPPETS[0]);
+	vector<double> incremental, full;
+	vector<size_t> relexed;
+	int mismatches = 0;
+	TextEdit last = {0, 0, ""};
+	string lastRemoved;
+	for (int i = 0; i < edits; i++) {
+		TextEdit e;
+		if (i % 2 == 0) {
+			e.offset = rng() % (lexer.getText().size() + 1);
+			e.removed = min((size_t)(rng() % 3), lexer.getText().size() - e.offset);
+			e.inserted = rng() % 4 ? EDIT_SNIPPETS[rng() % snippets] : "";
+			lastRemoved = lexer.getText().substr(e.offset, e.removed);
+			last = e;
+		} else {
+			e.offset = last.offset;
+			e.removed = last.inserted.size();
+			e.inserted = lastRemoved;
+		}
+
+		auto start = chrono::steady_clock::now();
+		pair<size_t, size_t> range;
+		if (!lexer.edit(e, range)) {
+			cerr << "edit " << i << " rejected at offset " << e.offset << endl;
+			return 1;
+		}
+		auto mid = chrono::steady_clock::now();
+		TokenBuffer expected = LexAnalyzer(string_view(lexer.getText())).tokenize();
+		auto stop = chrono::steady_clock::now();
+
+		incremental.push_back(chrono::duration<double>(mid - start).count());
+		full.push_back(chrono::duration<double>(stop - mid).count());
+		relexed.push_back(range.second - range.first);
+		if (!sameTokens(lexer.getTokens(), expected)) {
+			cerr << "mismatch after edit " << i << " at offset " << e.offset << endl;
+			mismatches++;
+		}
+	}
+	cout << fixed << setprecision(1);
+	cout << "input: " << bytes << " bytes, " << lexer.getTokens().size() << " tokens, "
+		<< edits << " edits" << endl;
+	double tFull = median(full), tIncremental = median(incremental);
+	cout << "full re-lex:  " << setw(10) << tFull * 1e6 << " us/edit (median)" << endl;
+	cout << "incremental:  " << setw(10) << tIncremental * 1e6 << " us/edit (median), "
+		<< median(relexed) << " tokens re-lexed (median), " << *max_element(relexed.begin(), relexed.end()) << " max" << endl;
+	cout << "speedup:      " << setw(10) << tFull / tIncremental << "x" << endl;
+	if (mismatches) {
+		cout << mismatches << " edits gave different tokens" << endl;
+	}
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,49 @@
+//----------------------------------------------------------------------
+// Compares the old ifstream::get/peek access pattern against the
+// InputBuffer pointer walk, then times the whole scanner.
+// usage: inputbench [source.pas] [copies]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Proj1.h"
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 10000;
+	string path = "/tmp/inputbench.pas";
+	size_t bytes = scaleCorpus(src, copies, path);
+	volatile long sink = 0;
+
+	double tStream = medianSeconds(BENCH_RUNS, [&]() {
+		ifstream file(path.c_str());
+		long sum = 0;
+		char c;
+		while ((c = file.get()) != CC_EOF) {
+			sum += c + file.peek();
+		}
+		sink = sum;
+	});
+	double tBuffer = medianSeconds(BENCH_RUNS, [&]() {
+		InputBuffer input;
+		input.open(path);
+		long sum = 0;
+		for (const char *p = input.begin(); p < input.end(); p++) {
+			sum += *p + (p + 1 < input.end() ? p[1] : CC_EOF);
+		}
+		sink = sum;
+	});
+	double tScan = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(path);
+		long count = 0;
+		while (!lex.finished()) {
+			count += lex.getNextLexeme().getType() != LexCat::none;
+		}
+		sink = count;
+	});
+
+	cout << fixed << setprecision(1);
+	cout << "input: " << bytes << " bytes" << endl;
+	cout << "ifstream get/peek: " << megabytesPerSec(bytes, tStream) << " MB/s" << endl;
+	cout << "InputBuffer walk:  " << megabytesPerSec(bytes, tBuffer) << " MB/s" << endl;
+	cout << "LexAnalyzer scan:  " << megabytesPerSec(bytes, tScan) << " MB/s" << endl;
+	return 0;
+}
@@ -0,0 +1,67 @@
+//----------------------------------------------------------------------
+// Identifier interning: lexing and then inserting each identifier's
+// text into a StringTable, against an analyzer that interns as it
+// reads (internInto). Counts heap allocations per identifier once the
+// table holds every name, i.e. in steady state.
+// usage: internbench [source.pas] [copies]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Proj1.h"
+
+#include "allocs.h"
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 10000;
+	string path = "/tmp/internbench.pas";
+	size_t bytes = scaleCorpus(src, copies, path);
+	InputBuffer input;
+	if (!input.open(path)) {
+		cerr << "File read error\n";
+		return 1;
+	}
+	string_view text(input.begin(), input.size());
+	size_t identifiers = 0;
+	size_t separateAllocs = 0, fusedAllocs = 0;
+
+	double tLexOnly = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(text);
+		while (!lex.finished()) {
+			lex.getNextLexeme();
+		}
+	});
+	StringTable separate;
+	double tSeparate = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(text);
+		size_t before = allocations;
+		identifiers = 0;
+		while (!lex.finished()) {
+			Lexeme l = lex.getNextLexeme();
+			if (l.getType() == LexCat::identifier) {
+				separate.insert(string(l.getBody()));
+				identifiers++;
+			}
+		}
+		separateAllocs = allocations - before;
+	});
+	StringTable fused;
+	double tFused = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(text);
+		lex.internInto(&fused);
+		size_t before = allocations;
+		while (!lex.finished()) {
+			lex.getNextLexeme();
+		}
+		fusedAllocs = allocations - before;
+	});
+
+	cout << fixed << setprecision(2);
+	cout << "input: " << bytes << " bytes, " << identifiers << " identifiers" << endl;
+	cout << "lex only:                  " << setw(7) << tLexOnly * 1e9 / identifiers
+		<< " ns/identifier" << endl;
+	cout << "lex, then insert(string):  " << setw(7) << tSeparate * 1e9 / identifiers
+		<< " ns/identifier, " << (double)separateAllocs / identifiers << " allocs/identifier" << endl;
+	cout << "interning analyzer:        " << setw(7) << tFused * 1e9 / identifiers
+		<< " ns/identifier, " << (double)fusedAllocs / identifiers << " allocs/identifier" << endl;
+	return 0;
+}
@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------
+// Keyword lookup: the constexpr perfect hash in findKeyword against a
+// std::unordered_map keyed by the lower-cased word. Words come from
+// lexing the corpus, so the hit/miss mix is a real program's; the
+// all-miss and all-hit sets isolate the two paths.
+// usage: kwbench [source.pas] [copies]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Proj1.h"
+
+#include <unordered_map>
+
+// one lookup per word, `rounds` times over; returns the sum of ids so
+// the work cannot be optimised away
+template <class F>
+static long lookupAll(const vector<string_view> &words, int rounds, F find) {
+	long sum = 0;
+	for (int r = 0; r < rounds; r++) {
+		for (string_view w : words) {
+			sum += (int)find(w);
+		}
+	}
+	return sum;
+}
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 1000;
+	string path = "/tmp/kwbench.pas";
+	scaleCorpus(src, copies, path);
+	ifstream in(path.c_str(), ios::binary);
+	string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	TokenBuffer tokens = LexAnalyzer(string_view(text)).tokenize();
+
+	vector<string_view> mixed, misses, hits;
+	for (size_t i = 0; i < tokens.size(); i++) {
+		if (tokens.kind[i] == LexCat::identifier || tokens.kind[i] == LexCat::keyword) {
+			mixed.push_back(tokens.text(i));
+			(tokens.kind[i] == LexCat::keyword ? hits : misses).push_back(tokens.text(i));
+		}
+	}
+
+	unordered_map<string, Keyword> table;
+	for (int k = 0; k < KEYWORD_COUNT; k++) {
+		table[KEYWORD_NAMES[k]] = (Keyword)k;
+	}
+	string lower;
+	auto naive = [&](string_view w) {
+		lower.assign(w.data(), w.size());
+		for (char &c : lower) {
+			c = tolower((unsigned char)c);
+		}
+		auto it = table.find(lower);
+		return it == table.end() ? Keyword::none : it->second;
+	};
+
+	const int rounds = 20;
+	struct { const char *name; const vector<string_view> *words; } sets[] = {
+		{"corpus", &mixed}, {"misses", &misses}, {"hits", &hits}
+	};
+	long check = 0;
+	cout << fixed << setprecision(2);
+	for (auto &set : sets) {
+		size_t n = set.words->size() * rounds;
+		long a = 0, b = 0;
+		double tHash = medianSeconds(BENCH_RUNS, [&]() { a = lookupAll(*set.words, rounds, [](string_view w) { return findKeyword(w); }); });
+		double tMap = medianSeconds(BENCH_RUNS, [&]() { b = lookupAll(*set.words, rounds, naive); });
+		if (a != b) {
+			cerr << set.name << ": lookups disagree" << endl;
+			return 1;
+		}
+		check += a;
+		cout << setw(7) << set.name << ": " << setw(7) << set.words->size() << " words  "
+			<< "perfect hash " << setw(6) << tHash * 1e9 / n << " ns  "
+			<< "unordered_map " << setw(6) << tMap * 1e9 / n << " ns" << endl;
+	}
+	return check == 0; // unreachable unless no keyword was found
+}
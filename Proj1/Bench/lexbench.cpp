@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------
+// Scanner throughput on generated Pascal. For each mix it reports MB/s,
+// tokens/s, ns/token (median and p99 over the timed runs) and heap
+// allocations per token, for tokenize(), for the getNextLexeme() pull
+// loop, and for that loop interning identifiers (internInto) into a
+// table that already holds them. --format json or csv gives one record
+// per mix and mode, for comparing builds.
+// usage: lexbench [--mix name|all] [--mb size] [--seed n] [--runs n]
+//                 [--warmup n] [--format text|json|csv] [--label text]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "corpus.h"
+#include "../Proj1.h"
+
+#include "allocs.h"
+
+#include <cmath>
+#include <cstring>
+
+struct BenchResult {
+	string mix;
+	string mode;
+	size_t bytes;
+	size_t tokens;
+	int runs;
+	double medianSeconds;
+	double p99Seconds;
+	double allocsPerToken;
+};
+
+//----------------------------------------------------------------------
+// 							timeRuns
+//----------------------------------------------------------------------
+// Runs f `warmup` times untimed, then `runs` times; returns the sorted
+// run times and leaves the allocations of the timed runs in allocs.
+//----------------------------------------------------------------------
+template <class F>
+static vector<double> timeRuns(int warmup, int runs, size_t &allocs, F f) {
+	for (int i = 0; i < warmup; i++) {
+		f();
+	}
+	vector<double> times;
+	size_t before = allocations;
+	for (int i = 0; i < runs; i++) {
+		auto start = chrono::steady_clock::now();
+		f();
+		times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+	}
+	allocs = allocations - before;
+	sort(times.begin(), times.end());
+	return times;
+}
+
+// nearest-rank percentile of sorted times
+static double percentile(const vector<double> &times, double p) {
+	size_t rank = (size_t)ceil(p / 100 * times.size());
+	return times[rank > 0 ? rank - 1 : 0];
+}
+
+//----------------------------------------------------------------------
+// 							printResults
+//----------------------------------------------------------------------
+static void printResults(const vector<BenchResult> &results, const string &format,
+		const string &label, uint32_t seed) {
+	if (format == "json") {
+		cout << "[" << endl;
+		for (size_t i = 0; i < results.size(); i++) {
+			const BenchResult &r = results[i];
+			cout << setprecision(6) << "  {\"label\": \"" << label << "\", \"seed\": " << seed
+				<< ", \"mix\": \"" << r.mix << "\", \"mode\": \"" << r.mode
+				<< "\", \"bytes\": " << r.bytes << ", \"tokens\": " << r.tokens
+				<< ", \"runs\": " << r.runs
+				<< ", \"mb_per_sec\": " << megabytesPerSec(r.bytes, r.medianSeconds)
+				<< ", \"tokens_per_sec\": " << r.tokens / r.medianSeconds
+				<< ", \"ns_per_token_median\": " << r.medianSeconds * 1e9 / r.tokens
+				<< ", \"ns_per_token_p99\": " << r.p99Seconds * 1e9 / r.tokens
+				<< ", \"allocs_per_token\": " << r.allocsPerToken << "}"
+				<< (i + 1 < results.size() ? "," : "") << endl;
+		}
+		cout << "]" << endl;
+	}
+	else if (format == "csv") {
+		cout << "label,seed,mix,mode,bytes,tokens,runs,mb_per_sec,tokens_per_sec,"
+			<< "ns_per_token_median,ns_per_token_p99,allocs_per_token" << endl;
+		for (const BenchResult &r : results) {
+			cout << setprecision(6) << label << "," << seed << "," << r.mix << "," << r.mode << ","
+				<< r.bytes << "," << r.tokens << "," << r.runs << ","
+				<< megabytesPerSec(r.bytes, r.medianSeconds) << "," << r.tokens / r.medianSeconds << ","
+				<< r.medianSeconds * 1e9 / r.tokens << "," << r.p99Seconds * 1e9 / r.tokens << ","
+				<< r.allocsPerToken << endl;
+		}
+	}
+	else {
+		cout << fixed << setprecision(1);
+		cout << setw(12) << "mix" << setw(10) << "mode" << setw(10) << "MB/s" << setw(10) << "Mtok/s"
+			<< setw(10) << "ns/tok" << setw(10) << "p99" << setw(12) << "allocs/tok" << endl;
+		for (const BenchResult &r : results) {
+			cout << setw(12) << r.mix << setw(10) << r.mode
+				<< setw(10) << megabytesPerSec(r.bytes, r.medianSeconds)
+				<< setw(10) << r.tokens / r.medianSeconds / 1e6
+				<< setw(10) << r.medianSeconds * 1e9 / r.tokens
+				<< setw(10) << r.p99Seconds * 1e9 / r.tokens
+				<< setw(12) << setprecision(4) << r.allocsPerToken << setprecision(1) << endl;
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	string mixName = "all", format = "text", label = "";
+	double megabytes = 16;
+	uint32_t seed = 441;
+	int runs = 10, warmup = 2;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--mix") == 0) mixName = argv[i + 1];
+		else if (strcmp(argv[i], "--mb") == 0) megabytes = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], NULL, 10);
+		else if (strcmp(argv[i], "--runs") == 0) runs = max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--warmup") == 0) warmup = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--format") == 0) format = argv[i + 1];
+		else if (strcmp(argv[i], "--label") == 0) label = argv[i + 1];
+		else {
+			cerr << "unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	vector<BenchResult> results;
+	for (int m = 0; m < MIX_COUNT; m++) {
+		if (mixName != "all" && mixName != MIX_NAMES[m]) {
+			continue;
+		}
+		string text = CorpusGenerator(seed).generate((Mix)m, megabytes * 1e6);
+		TokenBuffer check = LexAnalyzer(string_view(text)).tokenize();
+		if (check.error != LexError::none) {
+			cerr << MIX_NAMES[m] << ": generated source does not lex: "
+				<< errorString(check.error) << endl;
+			return 1;
+		}
+		size_t tokens = check.size();
+		size_t allocs;
+
+		vector<double> times = timeRuns(warmup, runs, allocs, [&]() {
+			TokenBuffer tokenBuffer = LexAnalyzer(string_view(text)).tokenize();
+		});
+		results.push_back({MIX_NAMES[m], "tokenize", text.size(), tokens, runs,
+			percentile(times, 50), percentile(times, 99), (double)allocs / runs / tokens});
+
+		times = timeRuns(warmup, runs, allocs, [&]() {
+			LexAnalyzer lex((string_view(text)));
+			while (!lex.finished()) {
+				lex.getNextLexeme();
+			}
+		});
+		results.push_back({MIX_NAMES[m], "pull", text.size(), tokens, runs,
+			percentile(times, 50), percentile(times, 99), (double)allocs / runs / tokens});
+
+		StringTable table; // every name is in it after the warmup
+		times = timeRuns(max(warmup, 1), runs, allocs, [&]() {
+			LexAnalyzer lex((string_view(text)));
+			lex.internInto(&table);
+			while (!lex.finished()) {
+				lex.getNextLexeme();
+			}
+		});
+		results.push_back({MIX_NAMES[m], "intern", text.size(), tokens, runs,
+			percentile(times, 50), percentile(times, 99), (double)allocs / runs / tokens});
+	}
+	if (results.empty()) {
+		cerr << "unknown mix " << mixName << endl;
+		return 1;
+	}
+	printResults(results, format, label, seed);
+	return 0;
+}
@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------
+// Numeric literals: what a consumer paid to turn token text into values
+// with stoll/stod or from_chars, against reading the value the scanner
+// now stores with each token. Inputs are the generated numbers mix and
+// Proj2/test2.txt (one integer per line) scaled up.
+// usage: numbench [copies of test2.txt] [MB of generated input]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "corpus.h"
+#include "../Proj1.h"
+
+#include <charconv>
+
+struct NumberTimes {
+	size_t numbers;
+	double lex;
+	double stdlib;
+	double fromChars;
+	double stored;
+};
+
+//----------------------------------------------------------------------
+// 							timeNumbers
+//----------------------------------------------------------------------
+static NumberTimes timeNumbers(const string &text) {
+	NumberTimes t;
+	TokenBuffer tokens;
+	t.lex = medianSeconds(BENCH_RUNS, [&]() {
+		tokens = LexAnalyzer(string_view(text)).tokenize();
+	});
+	vector<size_t> numbers;
+	for (size_t i = 0; i < tokens.size(); i++) {
+		if (tokens.kind[i] == LexCat::integer || tokens.kind[i] == LexCat::real) {
+			numbers.push_back(i);
+		}
+	}
+	t.numbers = numbers.size();
+	volatile double sink = 0;
+	t.stdlib = medianSeconds(BENCH_RUNS, [&]() {
+		double sum = 0;
+		for (size_t i : numbers) {
+			string s(tokens.text(i));
+			sum += tokens.kind[i] == LexCat::integer ? stoll(s) : stod(s);
+		}
+		sink = sum;
+	});
+	t.fromChars = medianSeconds(BENCH_RUNS, [&]() {
+		double sum = 0;
+		for (size_t i : numbers) {
+			string_view s = tokens.text(i);
+			if (tokens.kind[i] == LexCat::integer) {
+				long long v = 0;
+				from_chars(s.data(), s.data() + s.size(), v);
+				sum += v;
+			}
+			else {
+				double v = 0;
+				from_chars(s.data(), s.data() + s.size(), v);
+				sum += v;
+			}
+		}
+		sink = sum;
+	});
+	t.stored = medianSeconds(BENCH_RUNS, [&]() {
+		double sum = 0;
+		for (size_t i : numbers) {
+			sum += tokens.kind[i] == LexCat::integer ? tokens.value[i].integer : tokens.value[i].real;
+		}
+		sink = sum;
+	});
+	return t;
+}
+
+static void printTimes(const char *name, const NumberTimes &t) {
+	cout << name << ": " << t.numbers << " numbers" << endl;
+	cout << "  tokenize, values included  " << setw(7) << t.lex * 1e9 / t.numbers << " ns/number" << endl;
+	cout << "  stoll/stod on token text   " << setw(7) << t.stdlib * 1e9 / t.numbers << " ns/number" << endl;
+	cout << "  from_chars on token text   " << setw(7) << t.fromChars * 1e9 / t.numbers << " ns/number" << endl;
+	cout << "  stored value               " << setw(7) << t.stored * 1e9 / t.numbers << " ns/number" << endl;
+}
+
+int main(int argc, char **argv) {
+	int copies = argc > 1 ? atoi(argv[1]) : 20000;
+	double megabytes = argc > 2 ? atof(argv[2]) : 8;
+	string path = "/tmp/numbench.txt";
+	scaleCorpus("../../Proj2/test2.txt", copies, path);
+	ifstream in(path.c_str(), ios::binary);
+	string integers((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	string generated = CorpusGenerator(441).generate(Mix::numbers, megabytes * 1e6);
+
+	cout << fixed << setprecision(1);
+	printTimes("test2.txt", timeNumbers(integers));
+	printTimes("numbers mix", timeNumbers(generated));
+	return 0;
+}
@@ -0,0 +1,40 @@
+//----------------------------------------------------------------------
+// Scaling of tokenizeParallel over 1..N threads against the serial
+// tokenize() on one large file.
+// usage: parbench [source.pas] [copies] [max threads]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Parallel.h"
+
+#include <thread>
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 200000;
+	int maxThreads = argc > 3 ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+	string path = "/tmp/parbench.pas";
+	size_t bytes = scaleCorpus(src, copies, path);
+	InputBuffer input;
+	if (!input.open(path)) {
+		cerr << "File read error\n";
+		return 1;
+	}
+	string_view text(input.begin(), input.size());
+	size_t count = 0;
+
+	double tSerial = medianSeconds(3, [&]() {
+		count = LexAnalyzer(text).tokenize().size();
+	});
+	cout << fixed << setprecision(1);
+	cout << "input: " << bytes << " bytes, " << count << " tokens, "
+		<< thread::hardware_concurrency() << " hardware threads" << endl;
+	cout << "serial:     " << setw(8) << megabytesPerSec(bytes, tSerial) << " MB/s" << endl;
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		double t = medianSeconds(3, [&]() {
+			count = tokenizeParallel(text, threads).size();
+		});
+		cout << "threads " << setw(2) << threads << ": " << setw(8) << megabytesPerSec(bytes, t)
+			<< " MB/s  speedup " << setprecision(2) << tSerial / t << setprecision(1) << endl;
+	}
+	return 0;
+}
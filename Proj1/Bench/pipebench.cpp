@@ -0,0 +1,69 @@
+//----------------------------------------------------------------------
+// The scanner and a consumer run one after the other on one thread,
+// against the two-stage pipeline of Pipeline.h. Consumers are the
+// listing printer (to /dev/null) and a symbol table builder that enters
+// every identifier into Proj2's StringTable. The pipeline can only
+// overlap the stages when there is a second core to run on.
+// usage: pipebench [--mb size] [--seed n]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "corpus.h"
+#include "../Pipeline.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+	double megabytes = 16;
+	uint32_t seed = 441;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--mb") == 0) megabytes = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], NULL, 10);
+	}
+	string text = CorpusGenerator(seed).generate(Mix::mixed, megabytes * 1e6);
+	int devnull = open("/dev/null", O_WRONLY);
+	OutputWriter out(devnull), err(devnull, &out);
+
+	double tPrint = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex((string_view(text)));
+		lex.analyze(out, err);
+	});
+	double tPrintPiped = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex((string_view(text)));
+		analyzePipelined(lex, out, err);
+	});
+	double tTable = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex((string_view(text)));
+		StringTable table;
+		while (!lex.finished()) {
+			Lexeme lexeme = lex.getNextLexeme();
+			if (lexeme.getType() == LexCat::identifier) {
+				table.insert(string(lexeme.getBody()));
+			}
+		}
+	});
+	double tTablePiped = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex((string_view(text)));
+		StringTable table;
+		runPipeline(lex, [&](const PipelineEntry *batch, size_t n) {
+			for (size_t i = 0; i < n; i++) {
+				if (batch[i].lexeme.getType() == LexCat::identifier) {
+					table.insert(string(batch[i].lexeme.getBody()));
+				}
+			}
+		});
+	});
+	close(devnull);
+
+	cout << fixed << setprecision(1);
+	cout << "input: " << text.size() << " bytes, " << thread::hardware_concurrency()
+		<< " hardware threads" << endl;
+	cout << setw(14) << "consumer" << setw(14) << "serial MB/s" << setw(16) << "pipeline MB/s" << endl;
+	cout << setw(14) << "print" << setw(14) << megabytesPerSec(text.size(), tPrint)
+		<< setw(16) << megabytesPerSec(text.size(), tPrintPiped) << endl;
+	cout << setw(14) << "string table" << setw(14) << megabytesPerSec(text.size(), tTable)
+		<< setw(16) << megabytesPerSec(text.size(), tTablePiped) << endl;
+	return 0;
+}
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------
+// Times the scanner with each ScanKernels set on comment-heavy,
+// identifier-heavy and ordinary (pgm.pas) input.
+// usage: simdbench [source.pas] [copies]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Proj1.h"
+
+const int GENERATED_LINES = 200000;
+
+void writeCommentHeavy(const string &path) {
+	ofstream out(path.c_str());
+	for (int i = 0; i < GENERATED_LINES; i++) {
+		out << "\t(* record " << i << ": the running total is kept in sum so that the"
+			<< " average can be taken once every score has been read *)\n";
+		if (i % 8 == 0) {
+			out << "\tsum := sum + ascore;\n";
+		}
+	}
+}
+
+void writeIdentifierHeavy(const string &path) {
+	ofstream out(path.c_str());
+	for (int i = 0; i < GENERATED_LINES; i++) {
+		out << "\taccumulatedStudentScoreTotal" << i % 97 << " := previousSemesterAverageGrade"
+			<< i % 89 << " + numberOfOutstandingAssignments" << i << ";\n";
+	}
+}
+
+double scanSeconds(const string &path) {
+	volatile long sink = 0;
+	return medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(path);
+		long count = 0;
+		while (!lex.finished()) {
+			count += lex.getNextLexeme().getType() != LexCat::none;
+		}
+		sink = count;
+	});
+}
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 10000;
+	const char *names[] = {"scalar", "sse2", "avx2"};
+	string paths[] = {"/tmp/simdbench_comments.pas", "/tmp/simdbench_idents.pas", "/tmp/simdbench_pgm.pas"};
+	size_t bytes[3];
+
+	writeCommentHeavy(paths[0]);
+	writeIdentifierHeavy(paths[1]);
+	scaleCorpus(src, copies, paths[2]);
+	for (int i = 0; i < 3; i++) {
+		InputBuffer input;
+		input.open(paths[i]);
+		bytes[i] = input.size();
+	}
+
+	double rates[3][3] = {};
+	bool supported[3];
+	for (int k = 0; k < 3; k++) {
+		supported[k] = useScanKernels(names[k]);
+		for (int i = 0; supported[k] && i < 3; i++) {
+			rates[k][i] = megabytesPerSec(bytes[i], scanSeconds(paths[i]));
+		}
+	}
+
+	cout << fixed << setprecision(1);
+	cout << setw(8) << "kernels" << setw(12) << "comments" << setw(12) << "idents"
+		<< setw(12) << "pgm.pas" << "   (MB/s)" << endl;
+	for (int k = 0; k < 3; k++) {
+		cout << setw(8) << names[k];
+		if (!supported[k]) {
+			cout << "  unsupported" << endl;
+			continue;
+		}
+		for (int i = 0; i < 3; i++) {
+			cout << setw(12) << rates[k][i];
+		}
+		cout << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------
+// Listing a file through its memory map against listing it as a stream
+// (LexAnalyzer::openStream), read from the file itself and from a pipe
+// that a child process fills, at two input sizes. Output goes to
+// /dev/null. Peak heap is what each mode held at most beyond what was
+// live before it started; a stream's should be its window whatever the
+// input size. Exits 1 if a stream's listing differs from the mapped one.
+// usage: streambench [--mb size] [--seed n]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "corpus.h"
+#include "../Proj1.h"
+
+#include "allocs.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <sys/wait.h>
+#include <unistd.h>
+
+enum class Source {mapped, file, pipe};
+
+//----------------------------------------------------------------------
+// 							listInput
+//----------------------------------------------------------------------
+// Lists path, or a pipe carrying text, to out.
+//----------------------------------------------------------------------
+static void listInput(Source source, const string &path, const string &text, OutputWriter &out,
+		OutputWriter &err) {
+	LexAnalyzer lex;
+	if (source == Source::mapped) {
+		lex.open(path);
+		lex.analyze(out, err);
+		return;
+	}
+	int fd;
+	pid_t child = -1;
+	if (source == Source::file) {
+		fd = open(path.c_str(), O_RDONLY);
+	}
+	else {
+		int ends[2];
+		if (pipe(ends) != 0) return;
+		child = fork();
+		if (child == 0) {
+			close(ends[0]);
+			for (size_t done = 0; done < text.size(); ) {
+				ssize_t n = write(ends[1], text.data() + done, text.size() - done);
+				if (n <= 0) _exit(1);
+				done += n;
+			}
+			_exit(0);
+		}
+		close(ends[1]);
+		fd = ends[0];
+	}
+	lex.openStream(fd);
+	lex.analyze(out, err);
+	close(fd);
+	if (child > 0) {
+		waitpid(child, NULL, 0);
+	}
+}
+
+int main(int argc, char **argv) {
+	double megabytes = 64;
+	uint32_t seed = 441;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--mb") == 0) megabytes = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], NULL, 10);
+	}
+	const char *modes[] = {"mmap", "stream file", "stream pipe"};
+	string path = "/tmp/streambench.pas";
+	int devnull = open("/dev/null", O_WRONLY);
+	OutputWriter out(devnull), err(devnull, &out);
+	OutputWriter listing(MEMORY_ONLY), listingErr(MEMORY_ONLY, &listing);
+
+	cout << fixed << setprecision(1);
+	cout << setw(8) << "MB" << setw(14) << "mode" << setw(10) << "MB/s"
+		<< setw(16) << "peak heap KiB" << endl;
+	bool same = true;
+	for (double size : {megabytes / 4, megabytes}) {
+		string text = CorpusGenerator(seed).generate(Mix::mixed, size * 1e6);
+		ofstream(path.c_str(), ios::binary) << text;
+		string expected;
+		for (int m = 0; m < 3; m++) {
+			listing.clear();
+			listingErr.clear();
+			listInput((Source)m, path, text, listing, listingErr);
+			string got = string(listing.contents()) + string(listingErr.contents());
+			if (m == 0) {
+				expected = got;
+			}
+			else if (got != expected) {
+				cerr << modes[m] << ": listing differs" << endl;
+				same = false;
+			}
+		}
+		listing.clear();
+		listingErr.clear();
+		for (int m = 0; m < 3; m++) {
+			size_t before = liveBytes;
+			peakBytes = liveBytes;
+			listInput((Source)m, path, text, out, err);
+			size_t peak = peakBytes - before;
+			double seconds = medianSeconds(BENCH_RUNS, [&]() {
+				listInput((Source)m, path, text, out, err);
+			});
+			cout << setw(8) << size << setw(14) << modes[m]
+				<< setw(10) << megabytesPerSec(text.size(), seconds)
+				<< setw(16) << peak / 1024.0 << endl;
+		}
+	}
+	close(devnull);
+	unlink(path.c_str());
+	return same ? 0 : 1;
+}
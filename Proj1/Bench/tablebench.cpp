@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------
+// Proj2's open-addressing StringTable against the chained table it
+// replaced, from 1K to 10M identifier-like names: ns per insert of a
+// new name, per search that hits (in random order) and per search that
+// misses, heap bytes per entry once every name is in, and ns per entry
+// for destruct() to empty the full table. A chained table's chains are
+// entries / STRTBL_NUM_BUCKETS long, so it is only run up to
+// --chained-max entries.
+// usage: tablebench [--max entries] [--chained-max entries] [--seed n]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../../Proj2/proj2.h"
+
+#include "allocs.h"
+
+#include <cstring>
+#include <random>
+
+const size_t MAX_MISSES = 1000000;
+
+// names 4 to 20 characters long, about half with a shared prefix the
+// way a program's identifiers often have, and all distinct
+vector<string> makeNames(size_t n, mt19937 &random) {
+	const char *prefixes[] = {"student", "total", "index", "tmp", "record"};
+	const char *alnum = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+	vector<string> names;
+	names.reserve(n);
+	for (size_t i = 0; i < n; i++) {
+		string name = random() % 2 ? prefixes[random() % 5] : string(1, 'a' + random() % 26);
+		size_t length = 4 + random() % 17;
+		while (name.size() < length) {
+			name += alnum[random() % 63];
+		}
+		names.push_back(name + to_string(i)); // the suffix keeps them distinct
+	}
+	return names;
+}
+
+template <class F>
+double seconds(int runs, F f) {
+	return runs > 1 ? medianSeconds(runs, f) : [&]() {
+		auto start = chrono::steady_clock::now();
+		f();
+		return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}();
+}
+
+struct Result {
+	double insertNs, hitNs, missNs, bytesPerEntry, destructNs;
+};
+
+template <class Table>
+Result measure(const vector<string> &names, const vector<string> &hits,
+		const vector<string> &misses) {
+	int runs = names.size() >= 1000000 ? 1 : BENCH_RUNS;
+	Result r;
+	r.insertNs = seconds(runs, [&]() {
+		Table table;
+		for (const string &name : names) {
+			table.insert(name);
+		}
+	}) * 1e9 / names.size();
+
+	size_t before = liveBytes;
+	Table table;
+	for (const string &name : names) {
+		table.insert(name);
+	}
+	r.bytesPerEntry = (double)(liveBytes - before) / names.size();
+	volatile size_t found = 0;
+	r.hitNs = seconds(runs, [&]() {
+		size_t n = 0;
+		for (const string &name : hits) {
+			n += table.search(name) != NULL;
+		}
+		found = n;
+	}) * 1e9 / hits.size();
+	if (found != hits.size()) {
+		cerr << "a name went missing" << endl;
+		exit(1);
+	}
+	r.missNs = seconds(runs, [&]() {
+		size_t n = 0;
+		for (const string &name : misses) {
+			n += table.search(name) != NULL;
+		}
+		found = n;
+	}) * 1e9 / misses.size();
+	if (found != 0) {
+		cerr << "found a name never inserted" << endl;
+		exit(1);
+	}
+	vector<double> times;
+	for (int i = 0; i < runs; i++) {
+		for (const string &name : names) {
+			table.insert(name);
+		}
+		auto start = chrono::steady_clock::now();
+		table.destruct();
+		times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+	}
+	sort(times.begin(), times.end());
+	r.destructNs = times[times.size() / 2] * 1e9 / names.size();
+	return r;
+}
+
+void printRow(size_t n, const char *table, const Result &r) {
+	cout << setw(10) << n << setw(9) << table << setw(10) << r.insertNs << setw(10) << r.hitNs
+		<< setw(10) << r.missNs << setw(12) << r.bytesPerEntry << setw(10) << r.destructNs << endl;
+}
+
+int main(int argc, char **argv) {
+	size_t maxEntries = 10000000, chainedMax = 100000;
+	uint32_t seed = 441;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--max") == 0) maxEntries = strtoul(argv[i + 1], NULL, 10);
+		else if (strcmp(argv[i], "--chained-max") == 0) chainedMax = strtoul(argv[i + 1], NULL, 10);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], NULL, 10);
+	}
+	cout << fixed << setprecision(1);
+	cout << setw(10) << "entries" << setw(9) << "table" << setw(10) << "insert" << setw(10) << "hit"
+		<< setw(10) << "miss" << setw(12) << "bytes/entry" << setw(10) << "destruct"
+		<< "   (ns/op)" << endl;
+	for (size_t n = 1000; n <= maxEntries; n *= 10) {
+		mt19937 random(seed);
+		vector<string> names = makeNames(n, random);
+		vector<string> hits = names;
+		shuffle(hits.begin(), hits.end(), random);
+		vector<string> misses = makeNames(min(n, MAX_MISSES), random);
+		for (string &name : misses) {
+			name += '#'; // never an identifier's
+		}
+		printRow(n, "open", measure<StringTable>(names, hits, misses));
+		if (n <= chainedMax) {
+			printRow(n, "chained", measure<ChainedStringTable>(names, hits, misses));
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+//----------------------------------------------------------------------
+// Measures tokens/sec for tokenize(), the getNextLexeme() pull loop and
+// analyze() printing to /dev/null.
+// usage: tokenbench [source.pas] [copies]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../Proj1.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+	string src = argc > 1 ? argv[1] : "../pgm.pas";
+	int copies = argc > 2 ? atoi(argv[2]) : 10000;
+	string path = "/tmp/tokenbench.pas";
+	size_t bytes = scaleCorpus(src, copies, path);
+	size_t count = 0;
+
+	double tTokenize = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(path);
+		TokenBuffer tokens = lex.tokenize();
+		count = tokens.size();
+	});
+	double tPull = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(path);
+		size_t n = 0;
+		while (!lex.finished()) {
+			n += lex.getNextLexeme().getType() != LexCat::none;
+		}
+		count = n;
+	});
+	int devnull = open("/dev/null", O_WRONLY);
+	OutputWriter out(devnull), err(devnull, &out);
+	double tPrint = medianSeconds(BENCH_RUNS, [&]() {
+		LexAnalyzer lex(path);
+		lex.analyze(out, err);
+	});
+	close(devnull);
+
+	cout << fixed << setprecision(1);
+	cout << "input: " << bytes << " bytes, " << count << " tokens" << endl;
+	cout << "tokenize():       " << count / tTokenize / 1e6 << " Mtok/s, "
+		<< tTokenize * 1e9 / count << " ns/token" << endl;
+	cout << "getNextLexeme():  " << count / tPull / 1e6 << " Mtok/s, "
+		<< tPull * 1e9 / count << " ns/token" << endl;
+	cout << "analyze() print:  " << count / tPrint / 1e6 << " Mtok/s, "
+		<< tPrint * 1e9 / count << " ns/token" << endl;
+	return 0;
+}
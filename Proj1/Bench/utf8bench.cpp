@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------
+// Checks that every ScanKernels set stops its text runs (commentRun,
+// literalRun, asciiRun) at the same byte as the scalar set on random
+// mixes of ASCII, UTF-8 and malformed bytes, from every start offset
+// and with end cutting characters short; then times commentRun over
+// ASCII and over UTF-8 comment text with each set. Exits 1 on a
+// mismatch.
+// usage: utf8bench [--mb size] [--seed n]
+//----------------------------------------------------------------------
+#include "bench.h"
+#include "../ScanKernels.h"
+
+#include <cstring>
+#include <iomanip>
+#include <random>
+
+const int CHECK_BUFFERS = 2000;
+const size_t CHECK_LENGTH = 200;
+
+// pieces random text is made of: ASCII, each UTF-8 length, the
+// characters at the edges of the well-formed ranges, and malformed
+// sequences (overlong, surrogate, above U+10FFFF, stray and cut short)
+static const char *PIECES[] = {
+	"a", "Z", "0", " ", "*", "'", "\n", "\t", "~", "\x01",
+	"\xc3\xa9", "\xe6\x97\xa5", "\xf0\x9f\x98\x80",
+	"\xc2\x80", "\xdf\xbf", "\xe0\xa0\x80", "\xed\x9f\xbf", "\xee\x80\x80",
+	"\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf",
+	"\xc0\xaf", "\xc1\xbf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80",
+	"\xf5\x80\x80\x80", "\x80", "\xbf", "\xff", "\xc3", "\xe6\x97", "\xf0\x9f\x98",
+};
+
+string randomText(mt19937 &random, size_t length, int asciiWeight) {
+	const int pieces = sizeof(PIECES) / sizeof(PIECES[0]);
+	string text;
+	while (text.size() < length) {
+		int i = random() % (pieces + asciiWeight);
+		text += PIECES[i < pieces ? i : random() % 4];
+	}
+	return text;
+}
+
+// comment text with no CC_STAR or CC_EOL, so a run covers all of it
+string commentText(size_t bytes, bool utf8) {
+	const char *ascii = "the running total is kept in sum so that the average can be taken ";
+	const char *mixed = "la somme courante est gardée — 合計は sum に保存される 😀 ";
+	string text;
+	while (text.size() < bytes) {
+		text += utf8 ? mixed : ascii;
+	}
+	return text;
+}
+
+typedef const char *(*Run)(const char *, const char *);
+
+bool checkKernels(const ScanKernels *reference, const ScanKernels *kernels, uint32_t seed) {
+	Run runs[][2] = {
+		{reference->commentRun, kernels->commentRun},
+		{reference->literalRun, kernels->literalRun},
+		{reference->asciiRun, kernels->asciiRun},
+	};
+	const char *names[] = {"commentRun", "literalRun", "asciiRun"};
+	mt19937 random(seed);
+	for (int b = 0; b < CHECK_BUFFERS; b++) {
+		string text = randomText(random, CHECK_LENGTH, b % 3 * 20);
+		const char *end = text.data() + text.size();
+		for (size_t start = 0; start < text.size(); start++) {
+			const char *p = text.data() + start;
+			const char *cut = p + random() % (end - p + 1);
+			for (int r = 0; r < 3; r++) {
+				for (const char *stop : {end, cut}) {
+					if (runs[r][0](p, stop) != runs[r][1](p, stop)) {
+						cerr << kernels->name << " " << names[r] << ": buffer " << b
+							<< ", offset " << start << " differs from scalar" << endl;
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+double runSeconds(Run run, const string &text) {
+	volatile size_t sink = 0;
+	return medianSeconds(BENCH_RUNS, [&]() {
+		const char *p = text.data(), *end = p + text.size();
+		size_t stops = 0;
+		while (p < end) {
+			p = run(p, end) + 1;
+			stops++;
+		}
+		sink = stops;
+	});
+}
+
+int main(int argc, char **argv) {
+	double megabytes = 64;
+	uint32_t seed = 441;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--mb") == 0) megabytes = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], NULL, 10);
+	}
+	const char *names[] = {"scalar", "sse2", "avx2"};
+	const ScanKernels *sets[3] = {};
+	for (int k = 0; k < 3; k++) {
+		if (useScanKernels(names[k])) {
+			sets[k] = scanKernels;
+		}
+	}
+
+	bool same = true;
+	for (int k = 1; k < 3; k++) {
+		if (sets[k] != NULL && !checkKernels(sets[0], sets[k], seed)) {
+			same = false;
+		}
+	}
+
+	string ascii = commentText(megabytes * 1e6, false);
+	string utf8 = commentText(megabytes * 1e6, true);
+	cout << fixed << setprecision(1);
+	cout << setw(8) << "kernels" << setw(12) << "ascii" << setw(12) << "utf-8" << "   (MB/s)" << endl;
+	for (int k = 0; k < 3; k++) {
+		cout << setw(8) << names[k];
+		if (sets[k] == NULL) {
+			cout << "  unsupported" << endl;
+			continue;
+		}
+		cout << setw(12) << megabytesPerSec(ascii.size(), runSeconds(sets[k]->commentRun, ascii))
+			<< setw(12) << megabytesPerSec(utf8.size(), runSeconds(sets[k]->commentRun, utf8)) << endl;
+	}
+	cout << (same ? "all kernel sets agree" : "kernel sets differ") << endl;
+	return same ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include "Dfa.h"
+
+//----------------------------------------------------------------------
+// 							  addToken
+//----------------------------------------------------------------------
+// Appends the token source[start, end).
+//----------------------------------------------------------------------
+static void addToken(TokenBuffer &tokens, LexCat kind, const char *start, const char *end,
+		TokenValue value) {
+	tokens.kind.push_back(kind);
+	tokens.offset.push_back(start - tokens.source.data());
+	tokens.length.push_back(end - start);
+	tokens.value.push_back(value);
+}
+
+//----------------------------------------------------------------------
+// 							  addError
+//----------------------------------------------------------------------
+// Appends an error token source[start, end), listed at `at`.
+//----------------------------------------------------------------------
+static void addError(TokenBuffer &tokens, LexError error, const char *start, const char *end,
+		const char *at) {
+	TokenValue none;
+	none.integer = 0;
+	addToken(tokens, LexCat::error, start, end, none);
+	tokens.error = error;
+	tokens.errorPosition = at - tokens.source.data();
+}
+
+//----------------------------------------------------------------------
+// 							  acceptToken
+//----------------------------------------------------------------------
+// Appends the lexeme [start, end) that action ended.
+//----------------------------------------------------------------------
+static void acceptToken(TokenBuffer &tokens, DfaState action, const char *start, const char *end) {
+	TokenValue value;
+	value.integer = 0;
+	LexCat kind = LexCat::symbol;
+	bool overflow;
+	switch (action) {
+		case DfaState::acceptIdent:
+			kind = findKeyword(string_view(start, end - start)) == Keyword::none
+				? LexCat::identifier : LexCat::keyword;
+			break;
+		case DfaState::acceptInteger:
+		case DfaState::acceptIntegerBeforePeriod:
+			kind = LexCat::integer;
+			value.integer = parseInteger(start, end, overflow);
+			break;
+		case DfaState::acceptReal:
+			kind = LexCat::real;
+			value.real = parseReal(start, end);
+			break;
+		case DfaState::acceptLiteral:
+			kind = LexCat::character;
+			break;
+		default:
+			break;
+	}
+	addToken(tokens, kind, start, end, value);
+}
+
+//----------------------------------------------------------------------
+// 							  tokenizeDfa
+//----------------------------------------------------------------------
+// The inner loop follows the table until it reaches an action; p is
+// then the lookahead byte, or the end of the input, which is fed to the
+// table as CC_EOF. After a lexeme the scan restarts on the lookahead.
+//----------------------------------------------------------------------
+TokenBuffer tokenizeDfa(string_view source) {
+	TokenBuffer tokens;
+	tokens.source = source;
+	tokens.reserve(source.size() / TOKEN_SIZE_ESTIMATE + 1);
+	const char *p = source.data();
+	const char *end = p + source.size();
+	const char *start = p;
+	DfaState state = DfaState::start;
+	while (true) {
+		for (; p < end; p++) {
+			start = state == DfaState::start ? p : start;
+			state = DFA_TABLE(state, *p);
+			if ((int)state >= FIRST_DFA_ACTION) break;
+		}
+		bool eof = p == end || *p == CC_EOF;
+		if (p == end) {
+			start = state == DfaState::start ? p : start;
+			state = DFA_TABLE(state, CC_EOF);
+		}
+		if (state == DfaState::utf8Error) { // checked without reading any further
+			eof = false;
+		}
+		if (eof) {
+			tokens.eofToken = tokens.size();
+			tokens.eofOffset = p - source.data();
+		}
+		switch (state) {
+			case DfaState::finish:
+				return tokens;
+			case DfaState::badChar:
+				addError(tokens, LexError::unrecognizedChar, p, p, p);
+				return tokens;
+			case DfaState::utf8Error: {
+				const char *lead = p - 1;
+				while (((unsigned char)*lead & 0xc0) == 0x80) {
+					lead--;
+				}
+				addError(tokens, LexError::unrecognizedChar, lead, lead, lead);
+				return tokens;
+			}
+			case DfaState::digitError:
+				addError(tokens, LexError::digitExpected, start, p, start);
+				return tokens;
+			case DfaState::literalError:
+				addError(tokens, LexError::literalEnd, start, p, p - eof);
+				return tokens;
+			case DfaState::commentError:
+				addError(tokens, LexError::commentEnd, start, p, p - 1);
+				return tokens;
+			case DfaState::acceptIntegerBeforePeriod:
+				p--; // the first period starts the next lexeme
+				acceptToken(tokens, state, start, p);
+				break;
+			default:
+				acceptToken(tokens, state, start, p);
+				break;
+		}
+		if (eof) {
+			return tokens;
+		}
+		state = DfaState::start;
+	}
+}
@@ -0,0 +1,210 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include "Proj1.h"
+
+//----------------------------------------------------------------------
+// A second scanner engine: the same token rules as LexAnalyzer, written
+// as a list of transitions and compiled into a dense [state][byte]
+// table at compile time, so the scan is one table lookup per byte.
+// The states from FIRST_DFA_ACTION on are not real states. Reaching one
+// ends the lexeme, or the scan, and the byte that led there (the
+// lookahead) is left for the next lexeme, exactly as LexAnalyzer's
+// currentChar is. End of input reads as a CC_EOF byte.
+//----------------------------------------------------------------------
+enum class DfaState : unsigned char {start, ident, number, decimalpt, fraction, literal, quote,
+		lpar, comment, commentstar, less, greater, colon, period, symbol,
+		// part way through a UTF-8 character: the bytes it still needs,
+		// or which lead byte limits the range of its second
+		commentCont1, commentCont2, commentCont3, commentE0, commentED, commentF0, commentF4,
+		literalCont1, literalCont2, literalCont3, literalE0, literalED, literalF0, literalF4,
+		// actions
+		acceptIdent, acceptInteger, acceptIntegerBeforePeriod, acceptReal, acceptLiteral,
+		acceptSymbol, digitError, literalError, commentError, badChar, utf8Error, finish};
+
+const int FIRST_UTF8_STATE = (int)DfaState::commentCont1;
+const int FIRST_DFA_ACTION = (int)DfaState::acceptIdent;
+
+// `to` is taken from `from` on any byte of category `on`; CharCat::unknown
+// stands for every category the state lists no rule for. An invalid
+// byte is an unrecognized character wherever it is read.
+struct DfaRule {
+	DfaState from;
+	CharCat on;
+	DfaState to;
+};
+
+constexpr DfaRule DFA_RULES[] = {
+	{DfaState::start, CharCat::whitespc, DfaState::start},
+	{DfaState::start, CharCat::eol, DfaState::start},
+	{DfaState::start, CharCat::eof, DfaState::finish},
+	{DfaState::start, CharCat::alpha, DfaState::ident},
+	{DfaState::start, CharCat::digit, DfaState::number},
+	{DfaState::start, CharCat::quote, DfaState::literal},
+	{DfaState::start, CharCat::leftpar, DfaState::lpar},
+	{DfaState::start, CharCat::lessthan, DfaState::less},
+	{DfaState::start, CharCat::greatthan, DfaState::greater},
+	{DfaState::start, CharCat::colon, DfaState::colon},
+	{DfaState::start, CharCat::period, DfaState::period},
+	{DfaState::start, CharCat::rightpar, DfaState::symbol},
+	{DfaState::start, CharCat::star, DfaState::symbol},
+	{DfaState::start, CharCat::equals, DfaState::symbol},
+	{DfaState::start, CharCat::sym, DfaState::symbol},
+	{DfaState::start, CharCat::unknown, DfaState::badChar},
+
+	{DfaState::ident, CharCat::alpha, DfaState::ident},
+	{DfaState::ident, CharCat::digit, DfaState::ident},
+	{DfaState::ident, CharCat::unknown, DfaState::acceptIdent},
+
+	{DfaState::number, CharCat::digit, DfaState::number},
+	{DfaState::number, CharCat::period, DfaState::decimalpt},
+	{DfaState::number, CharCat::unknown, DfaState::acceptInteger},
+	// "12.." is 12 followed by ".."
+	{DfaState::decimalpt, CharCat::period, DfaState::acceptIntegerBeforePeriod},
+	{DfaState::decimalpt, CharCat::digit, DfaState::fraction},
+	{DfaState::decimalpt, CharCat::unknown, DfaState::digitError},
+	{DfaState::fraction, CharCat::digit, DfaState::fraction},
+	{DfaState::fraction, CharCat::unknown, DfaState::acceptReal},
+
+	{DfaState::literal, CharCat::quote, DfaState::quote},
+	{DfaState::literal, CharCat::eol, DfaState::literalError},
+	{DfaState::literal, CharCat::eof, DfaState::literalError},
+	{DfaState::literal, CharCat::unknown, DfaState::literal},
+	// a doubled quote stays in the literal
+	{DfaState::quote, CharCat::quote, DfaState::literal},
+	{DfaState::quote, CharCat::unknown, DfaState::acceptLiteral},
+
+	{DfaState::lpar, CharCat::star, DfaState::comment},
+	{DfaState::lpar, CharCat::unknown, DfaState::acceptSymbol},
+	{DfaState::comment, CharCat::star, DfaState::commentstar},
+	{DfaState::comment, CharCat::eof, DfaState::commentError},
+	{DfaState::comment, CharCat::unknown, DfaState::comment},
+	{DfaState::commentstar, CharCat::rightpar, DfaState::start},
+	{DfaState::commentstar, CharCat::star, DfaState::commentstar},
+	{DfaState::commentstar, CharCat::eof, DfaState::commentError},
+	{DfaState::commentstar, CharCat::unknown, DfaState::comment},
+
+	{DfaState::less, CharCat::greatthan, DfaState::symbol},
+	{DfaState::less, CharCat::equals, DfaState::symbol},
+	{DfaState::less, CharCat::unknown, DfaState::acceptSymbol},
+	{DfaState::greater, CharCat::equals, DfaState::symbol},
+	{DfaState::greater, CharCat::unknown, DfaState::acceptSymbol},
+	{DfaState::colon, CharCat::equals, DfaState::symbol},
+	{DfaState::colon, CharCat::unknown, DfaState::acceptSymbol},
+	{DfaState::period, CharCat::period, DfaState::symbol},
+	{DfaState::period, CharCat::unknown, DfaState::acceptSymbol},
+	// a finished symbol still reads its lookahead, like every lexeme
+	{DfaState::symbol, CharCat::unknown, DfaState::acceptSymbol},
+};
+
+// Well-formed UTF-8 is allowed inside comments and literals. These
+// rules take bytes rather than categories, since the range allowed for
+// a character's second byte depends on its first (the Unicode table of
+// well-formed byte sequences). A UTF-8 state goes to utf8Error on any
+// byte without a rule, which is reported at the character's first byte.
+struct DfaByteRule {
+	DfaState from;
+	unsigned char lo; // inclusive
+	unsigned char hi;
+	DfaState to;
+};
+
+constexpr DfaByteRule DFA_UTF8_RULES[] = {
+	{DfaState::comment, 0xc2, 0xdf, DfaState::commentCont1},
+	{DfaState::comment, 0xe0, 0xe0, DfaState::commentE0},
+	{DfaState::comment, 0xe1, 0xec, DfaState::commentCont2},
+	{DfaState::comment, 0xed, 0xed, DfaState::commentED},
+	{DfaState::comment, 0xee, 0xef, DfaState::commentCont2},
+	{DfaState::comment, 0xf0, 0xf0, DfaState::commentF0},
+	{DfaState::comment, 0xf1, 0xf3, DfaState::commentCont3},
+	{DfaState::comment, 0xf4, 0xf4, DfaState::commentF4},
+	{DfaState::commentstar, 0xc2, 0xdf, DfaState::commentCont1},
+	{DfaState::commentstar, 0xe0, 0xe0, DfaState::commentE0},
+	{DfaState::commentstar, 0xe1, 0xec, DfaState::commentCont2},
+	{DfaState::commentstar, 0xed, 0xed, DfaState::commentED},
+	{DfaState::commentstar, 0xee, 0xef, DfaState::commentCont2},
+	{DfaState::commentstar, 0xf0, 0xf0, DfaState::commentF0},
+	{DfaState::commentstar, 0xf1, 0xf3, DfaState::commentCont3},
+	{DfaState::commentstar, 0xf4, 0xf4, DfaState::commentF4},
+	{DfaState::commentCont1, 0x80, 0xbf, DfaState::comment},
+	{DfaState::commentCont2, 0x80, 0xbf, DfaState::commentCont1},
+	{DfaState::commentCont3, 0x80, 0xbf, DfaState::commentCont2},
+	{DfaState::commentE0, 0xa0, 0xbf, DfaState::commentCont1},
+	{DfaState::commentED, 0x80, 0x9f, DfaState::commentCont1},
+	{DfaState::commentF0, 0x90, 0xbf, DfaState::commentCont2},
+	{DfaState::commentF4, 0x80, 0x8f, DfaState::commentCont2},
+
+	{DfaState::literal, 0xc2, 0xdf, DfaState::literalCont1},
+	{DfaState::literal, 0xe0, 0xe0, DfaState::literalE0},
+	{DfaState::literal, 0xe1, 0xec, DfaState::literalCont2},
+	{DfaState::literal, 0xed, 0xed, DfaState::literalED},
+	{DfaState::literal, 0xee, 0xef, DfaState::literalCont2},
+	{DfaState::literal, 0xf0, 0xf0, DfaState::literalF0},
+	{DfaState::literal, 0xf1, 0xf3, DfaState::literalCont3},
+	{DfaState::literal, 0xf4, 0xf4, DfaState::literalF4},
+	{DfaState::literalCont1, 0x80, 0xbf, DfaState::literal},
+	{DfaState::literalCont2, 0x80, 0xbf, DfaState::literalCont1},
+	{DfaState::literalCont3, 0x80, 0xbf, DfaState::literalCont2},
+	{DfaState::literalE0, 0xa0, 0xbf, DfaState::literalCont1},
+	{DfaState::literalED, 0x80, 0x9f, DfaState::literalCont1},
+	{DfaState::literalF0, 0x90, 0xbf, DfaState::literalCont2},
+	{DfaState::literalF4, 0x80, 0x8f, DfaState::literalCont2},
+};
+
+struct DfaTable {
+	DfaState next[FIRST_DFA_ACTION][256];
+	bool complete; // every state has a move on every byte
+
+	constexpr DfaTable() : next(), complete(true) {
+		for (int s = 0; s < FIRST_DFA_ACTION; s++) {
+			for (int b = 0; b < 256; b++) {
+				next[s][b] = s >= FIRST_UTF8_STATE ? DfaState::utf8Error
+					: transition((DfaState)s, CHAR_CATEGORIES[(char)b]);
+			}
+		}
+		for (const DfaByteRule &rule : DFA_UTF8_RULES) {
+			for (int b = rule.lo; b <= rule.hi; b++) {
+				next[(int)rule.from][b] = rule.to;
+			}
+		}
+	}
+
+	constexpr DfaState transition(DfaState from, CharCat on) {
+		if (on == CharCat::invalid) {
+			return DfaState::badChar;
+		}
+		const DfaRule *fallback = NULL;
+		for (const DfaRule &rule : DFA_RULES) {
+			if (rule.from == from && rule.on == on) {
+				return rule.to;
+			}
+			if (rule.from == from && rule.on == CharCat::unknown) {
+				fallback = &rule;
+			}
+		}
+		if (fallback == NULL) {
+			complete = false;
+			return DfaState::badChar;
+		}
+		return fallback->to;
+	}
+
+	constexpr DfaState operator()(DfaState s, unsigned char c) const { return next[(int)s][c]; }
+};
+
+inline constexpr DfaTable DFA_TABLE;
+
+static_assert(DFA_TABLE.complete, "every DFA state needs a CharCat::unknown rule");
+static_assert(DFA_TABLE(DfaState::start, (unsigned char)CC_EOF) == DfaState::finish,
+	"0xff must read as end of file");
+static_assert(DFA_TABLE(DfaState::comment, '~') == DfaState::badChar,
+	"an invalid byte is an error even inside a comment");
+static_assert(DFA_TABLE(DfaState::commentstar, ')') == DfaState::start, "star-paren ends a comment");
+static_assert(DFA_TABLE(DfaState::ident, 0xc3) == DfaState::badChar, "identifiers are ASCII");
+static_assert(DFA_TABLE(DfaState::literalE0, 0x9f) == DfaState::utf8Error, "no overlong forms");
+
+// Lexes all of source and returns the TokenBuffer LexAnalyzer(source)
+// .tokenize() would. Identifiers are not interned.
+TokenBuffer tokenizeDfa(string_view source);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// A lazy sequence produced by a coroutine that co_yields T values, for
+// use in a range for. Nothing runs until the first value is asked for,
+// and each step runs the coroutine up to its next co_yield. The
+// yielded value is not copied: *it refers to the coroutine's own
+// object, which is only valid until the iterator is advanced. The
+// coroutine frame is the only allocation, made once per Generator.
+//----------------------------------------------------------------------
+template <class T>
+class Generator {
+public:
+	struct promise_type {
+		const T *current = NULL;
+
+		Generator get_return_object() { return Generator(Handle::from_promise(*this)); }
+		suspend_always initial_suspend() noexcept { return {}; }
+		suspend_always final_suspend() noexcept { return {}; }
+		suspend_always yield_value(const T &value) noexcept {
+			current = &value;
+			return {};
+		}
+		void return_void() {}
+		void unhandled_exception() { throw; }
+	};
+	typedef coroutine_handle<promise_type> Handle;
+
+	struct Sentinel {};
+
+	class Iterator {
+		Handle coroutine;
+	public:
+		typedef input_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const T *pointer;
+		typedef const T &reference;
+
+		explicit Iterator(Handle h) : coroutine(h) {}
+		const T &operator*() const { return *coroutine.promise().current; }
+		const T *operator->() const { return coroutine.promise().current; }
+		Iterator &operator++() {
+			coroutine.resume();
+			return *this;
+		}
+		void operator++(int) { ++*this; }
+		bool operator==(Sentinel) const { return coroutine.done(); }
+	};
+
+	explicit Generator(Handle h) : coroutine(h) {}
+	Generator(Generator &&other) noexcept : coroutine(other.coroutine) { other.coroutine = nullptr; }
+	Generator &operator=(Generator &&other) noexcept {
+		if (this != &other) {
+			if (coroutine) coroutine.destroy();
+			coroutine = other.coroutine;
+			other.coroutine = nullptr;
+		}
+		return *this;
+	}
+	Generator(const Generator &) = delete;
+	Generator &operator=(const Generator &) = delete;
+	~Generator() {
+		if (coroutine) coroutine.destroy();
+	}
+
+	// runs the coroutine to its first co_yield; begin() is meant to be
+	// called once
+	Iterator begin() {
+		coroutine.resume();
+		return Iterator(coroutine);
+	}
+	Sentinel end() const { return Sentinel(); }
+
+private:
+	Handle coroutine;
+}; // Generator
+
+#endif
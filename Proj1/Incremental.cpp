@@ -0,0 +1,124 @@
+#include "Incremental.h"
+
+#include <algorithm>
+
+// bytes past the end of a token that the scanner may have examined: the
+// character that ended it and the one peekChar looks at after "12."
+const size_t TOKEN_LOOKAHEAD = 2;
+
+//----------------------------------------------------------------------
+// 							spliceArray
+//----------------------------------------------------------------------
+// Replaces a[first, last) with the first n entries of b.
+//----------------------------------------------------------------------
+template <class T>
+static void spliceArray(TokenArray<T> &a, size_t first, size_t last,
+		const TokenArray<T> &b, size_t n) {
+	if (last - first != n) {
+		a.erase(a.begin() + first, a.begin() + last);
+		a.insert(a.begin() + first, n, T());
+	}
+	copy_n(b.begin(), n, a.begin() + first);
+}
+
+//----------------------------------------------------------------------
+// 							IncrementalLexer Constructor
+//----------------------------------------------------------------------
+IncrementalLexer::IncrementalLexer(string source) : text(move(source)) {
+	tokens = LexAnalyzer(string_view(text)).tokenize();
+}
+
+//----------------------------------------------------------------------
+// 							IncrementalLexer::edit
+//----------------------------------------------------------------------
+// Applies e to the text and re-lexes as little of it as possible.
+//----------------------------------------------------------------------
+bool IncrementalLexer::edit(const TextEdit &e, pair<size_t, size_t> &relexed) {
+	if (e.offset > text.size() || e.removed > text.size() - e.offset) {
+		return false;
+	}
+	text.replace(e.offset, e.removed, e.inserted.data(), e.inserted.size());
+	tokens.source = text;
+	long delta = (long)e.inserted.size() - (long)e.removed;
+	size_t oldEnd = e.offset + e.removed;
+	size_t newEnd = e.offset + e.inserted.size();
+
+	// tokens [0, first) were lexed without seeing the edited bytes
+	size_t n = tokens.size();
+	size_t first = 0;
+	size_t hi = n;
+	while (first < hi) {
+		size_t mid = first + (hi - first) / 2;
+		if (tokens.offset[mid] + tokens.length[mid] + TOKEN_LOOKAHEAD <= e.offset) {
+			first = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	// the old scan stopped before the edit, so the new one does too
+	if (first > 0 && (tokens.kind[first - 1] == LexCat::error || tokens.eofToken < first)) {
+		relexed = make_pair(first, first);
+		return true;
+	}
+
+	size_t restart = 0;
+	if (first > 0) {
+		restart = tokens.offset[first - 1] + tokens.length[first - 1];
+	}
+	LexAnalyzer lex(string_view(text), restart);
+	TokenBuffer fresh;
+	fresh.source = text;
+
+	size_t sync = first;
+	bool synced = false;
+	while (!lex.finished() && !synced) {
+		size_t before = fresh.size();
+		lex.tokenizeNext(fresh);
+		if (fresh.size() == before || fresh.offset[before] < newEnd) {
+			continue;
+		}
+		size_t oldStart = fresh.offset[before] - delta;
+		while (sync < n && tokens.offset[sync] < oldStart) {
+			sync++;
+		}
+		synced = sync < n && tokens.offset[sync] == oldStart && oldStart >= oldEnd;
+	}
+
+	if (!synced) {
+		size_t count = fresh.size();
+		spliceArray(tokens.kind, first, n, fresh.kind, count);
+		spliceArray(tokens.offset, first, n, fresh.offset, count);
+		spliceArray(tokens.length, first, n, fresh.length, count);
+		spliceArray(tokens.value, first, n, fresh.value, count);
+		tokens.error = fresh.error;
+		tokens.errorPosition = fresh.errorPosition;
+		tokens.eofToken = fresh.eofToken == SIZE_MAX ? SIZE_MAX : first + fresh.eofToken;
+		tokens.eofOffset = fresh.eofOffset;
+		relexed = make_pair(first, first + count);
+		return true;
+	}
+
+	// the last fresh token is old token `sync`, moved
+	size_t count = fresh.size() - 1;
+	if (tokens.error != LexError::none) {
+		tokens.errorPosition += delta;
+	}
+	if (tokens.eofToken != SIZE_MAX) {
+		tokens.eofToken = tokens.eofToken - sync + first + count;
+		tokens.eofOffset += delta;
+	}
+	spliceArray(tokens.kind, first, sync, fresh.kind, count);
+	spliceArray(tokens.offset, first, sync, fresh.offset, count);
+	spliceArray(tokens.length, first, sync, fresh.length, count);
+	spliceArray(tokens.value, first, sync, fresh.value, count);
+
+	// lines and columns follow from the offsets, so only those move; this
+	// pass, like the splices, is over every later token
+	if (delta != 0) {
+		for (size_t i = first + count; i < tokens.size(); i++) {
+			tokens.offset[i] += delta;
+		}
+	}
+	relexed = make_pair(first, first + count);
+	return true;
+}
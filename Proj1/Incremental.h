@@ -0,0 +1,42 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "Proj1.h"
+
+#include <utility>
+
+// One change to the text: `removed` bytes at `offset` replaced by
+// `inserted`.
+struct TextEdit {
+	size_t offset;
+	size_t removed;
+	string_view inserted;
+};
+
+// Owns a source text and keeps its TokenBuffer up to date as the text
+// is edited. An edit is re-lexed from the end of the last token whose
+// lexing could not have looked at the changed bytes, and re-lexing stops
+// at the first new token that begins, past the edit, exactly where a
+// (shifted) old token began: both scans are then in the start state on
+// identical text, so the rest of the old stream is reused with its
+// offsets moved (tokens keep no lines or columns to fix up). Only the
+// re-lex is proportional to the edit: the text and the token arrays are
+// flat, so splicing them and moving the later offsets costs a pass over
+// everything after the edit, at the speed of a memmove.
+class IncrementalLexer {
+	string text;
+	TokenBuffer tokens;
+public:
+	IncrementalLexer(string source);
+
+	// applies e and sets relexed to the range [first, last) of token
+	// indexes that were re-lexed; every other token is unchanged apart
+	// from its position. Returns false, changing nothing, if the removed
+	// bytes are not all within the text.
+	bool edit(const TextEdit &e, pair<size_t, size_t> &relexed);
+
+	const string &getText() const { return text; }
+	const TokenBuffer &getTokens() const { return tokens; }
+}; // IncrementalLexer
+
+#endif
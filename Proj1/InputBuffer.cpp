@@ -0,0 +1,188 @@
+#include "InputBuffer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char EMPTY_INPUT[1] = {0};
+
+//----------------------------------------------------------------------
+// 							InputBuffer Constructor
+//----------------------------------------------------------------------
+InputBuffer::InputBuffer() {
+	data = EMPTY_INPUT;
+	length = 0;
+	mapped = NULL;
+}
+
+//----------------------------------------------------------------------
+// 							InputBuffer Destructor
+//----------------------------------------------------------------------
+InputBuffer::~InputBuffer() {
+	close();
+}
+
+//----------------------------------------------------------------------
+// 							InputBuffer::open
+//----------------------------------------------------------------------
+// Loads the named file. Returns false if it cannot be opened or read.
+//----------------------------------------------------------------------
+bool InputBuffer::open(const string &filename) {
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = openFd(fd);
+	::close(fd);
+	return ok;
+}
+
+//----------------------------------------------------------------------
+// 							InputBuffer::openFd
+//----------------------------------------------------------------------
+// Maps a regular file read-only; falls back to chunked reads for
+// anything mmap refuses (pipes, ttys, /proc files).
+//----------------------------------------------------------------------
+bool InputBuffer::openFd(int fd) {
+	close();
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			madvise(p, st.st_size, MADV_SEQUENTIAL);
+			mapped = p;
+			data = (const char *)p;
+			length = st.st_size;
+			return true;
+		}
+	}
+	return readAll(fd);
+}
+
+//----------------------------------------------------------------------
+// 							InputBuffer::readAll
+//----------------------------------------------------------------------
+// Reads fd to end of file in READ_CHUNK_SIZE pieces.
+//----------------------------------------------------------------------
+bool InputBuffer::readAll(int fd) {
+	size_t used = 0;
+	storage.resize(READ_CHUNK_SIZE);
+	while (true) {
+		if (storage.size() - used < READ_CHUNK_SIZE) {
+			storage.resize(storage.size() * 2);
+		}
+		ssize_t n = read(fd, storage.data() + used, storage.size() - used);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			storage.clear();
+			return false;
+		}
+		if (n == 0) break;
+		used += n;
+	}
+	storage.resize(used);
+	data = used ? storage.data() : EMPTY_INPUT;
+	length = used;
+	return true;
+}
+
+//----------------------------------------------------------------------
+// 							InputBuffer::close
+//----------------------------------------------------------------------
+// Releases the input. The read buffer keeps its capacity so a reused
+// InputBuffer does not reallocate for every file.
+//----------------------------------------------------------------------
+void InputBuffer::close() {
+	if (mapped != NULL) {
+		munmap(mapped, length);
+		mapped = NULL;
+	}
+	storage.clear();
+	data = EMPTY_INPUT;
+	length = 0;
+}
+
+//----------------------------------------------------------------------
+// 							InputBuffer::prefetch
+//----------------------------------------------------------------------
+// Asks the kernel to start reading filename into the page cache so a
+// later open() finds it there.
+//----------------------------------------------------------------------
+void InputBuffer::prefetch(const string &filename) {
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd >= 0) {
+		posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+		::close(fd);
+	}
+}
+
+//----------------------------------------------------------------------
+// 							StreamWindow Constructor
+//----------------------------------------------------------------------
+StreamWindow::StreamWindow() {
+	fd = -1;
+	used = 0;
+	start = 0;
+	ended = true;
+}
+
+//----------------------------------------------------------------------
+// 							StreamWindow::open
+//----------------------------------------------------------------------
+// A read error is treated as the end of the input.
+//----------------------------------------------------------------------
+void StreamWindow::open(int fd, size_t windowSize) {
+	this->fd = fd;
+	if (buffer.size() < windowSize) {
+		buffer.resize(windowSize);
+	}
+	used = 0;
+	start = 0;
+	ended = false;
+	refill(0);
+}
+
+//----------------------------------------------------------------------
+// 							StreamWindow::close
+//----------------------------------------------------------------------
+// Stops reading. The buffer keeps its capacity for the next open().
+//----------------------------------------------------------------------
+void StreamWindow::close() {
+	fd = -1;
+	used = 0;
+	start = 0;
+	ended = true;
+}
+
+//----------------------------------------------------------------------
+// 							StreamWindow::refill
+//----------------------------------------------------------------------
+// Moves the kept bytes to the front and reads once into the rest of the
+// buffer; a pipe hands over what it has, which is enough to go on with.
+// The buffer doubles only when the kept bytes leave no room to read.
+//----------------------------------------------------------------------
+bool StreamWindow::refill(size_t keep) {
+	if (ended) {
+		return false;
+	}
+	size_t drop = keep - start;
+	memmove(buffer.data(), buffer.data() + drop, used - drop);
+	used -= drop;
+	start = keep;
+	if (used == buffer.size()) {
+		buffer.resize(buffer.size() * 2);
+	}
+	ssize_t n;
+	do {
+		n = read(fd, buffer.data() + used, buffer.size() - used);
+	} while (n < 0 && errno == EINTR);
+	if (n <= 0) {
+		ended = true;
+		return false;
+	}
+	used += n;
+	return true;
+}
@@ -0,0 +1,75 @@
+#ifndef INPUTBUFFER_H
+#define INPUTBUFFER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+const size_t READ_CHUNK_SIZE = 1 << 20;
+const size_t STREAM_WINDOW_SIZE = 1 << 20; // a StreamWindow's buffer, unless a lexeme is longer
+
+// Holds the entire source file in memory. Regular files are mapped
+// read-only; pipes, ttys and anything else that cannot be mapped are
+// read in large chunks into an owned buffer.
+class InputBuffer {
+	const char *data;
+	size_t length;
+	void *mapped;
+	vector<char> storage;
+
+	bool readAll(int fd);
+public:
+	InputBuffer();
+	~InputBuffer();
+	InputBuffer(const InputBuffer &) = delete;
+	InputBuffer &operator=(const InputBuffer &) = delete;
+
+	bool open(const string &filename);
+	bool openFd(int fd);
+	void close();
+	// starts reading a file into the page cache without waiting for it
+	static void prefetch(const string &filename);
+
+	const char *begin() const { return data; }
+	const char *end() const { return data + length; }
+	size_t size() const { return length; }
+}; // InputBuffer
+
+// A bounded window onto input that is read from a file descriptor as it
+// is lexed, for pipes and other input that is never whole in memory.
+// The window holds input offsets [base(), base() + size()). refill()
+// drops the bytes before an offset, which the scanner sets at the start
+// of the lexeme it is in the middle of (or at its cursor between
+// lexemes and in comments), and reads more after the rest. The buffer is
+// allocated once and only grows when the kept bytes fill it, that is
+// for a single lexeme longer than it; lines may be any length. The
+// caller keeps ownership of the descriptor.
+class StreamWindow {
+	int fd;
+	vector<char> buffer;
+	size_t used;
+	size_t start; // input offset of buffer[0]
+	bool ended;
+public:
+	StreamWindow();
+	StreamWindow(const StreamWindow &) = delete;
+	StreamWindow &operator=(const StreamWindow &) = delete;
+
+	// starts on fd and reads the first window
+	void open(int fd, size_t windowSize = STREAM_WINDOW_SIZE);
+	void close();
+	bool isOpen() const { return fd >= 0; }
+	// keeps input from offset keep on (keep >= base()) and reads more;
+	// false if there was no more. Once the input has ended this returns
+	// false at once and leaves the window as it is.
+	bool refill(size_t keep);
+
+	const char *begin() const { return buffer.data(); }
+	size_t size() const { return used; }
+	size_t base() const { return start; }
+	bool atEnd() const { return ended; }
+}; // StreamWindow
+
+#endif
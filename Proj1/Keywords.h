@@ -0,0 +1,143 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include <string_view>
+#include <cstdint>
+
+using namespace std;
+
+// Pascal's reserved words (ISO 7185), in the order of KEYWORD_NAMES
+enum class Keyword : signed char {AND, ARRAY, BEGIN, CASE, CONST, DIV, DO, DOWNTO, ELSE, END, FILE,
+		FOR, FUNCTION, GOTO, IF, IN, LABEL, MOD, NIL, NOT, OF, OR, PACKED, PROCEDURE, PROGRAM,
+		RECORD, REPEAT, SET, THEN, TO, TYPE, UNTIL, VAR, WHILE, WITH, none=-1};
+
+constexpr const char *KEYWORD_NAMES[] = {"and", "array", "begin", "case", "const", "div", "do",
+	"downto", "else", "end", "file", "for", "function", "goto", "if", "in", "label", "mod", "nil",
+	"not", "of", "or", "packed", "procedure", "program", "record", "repeat", "set", "then", "to",
+	"type", "until", "var", "while", "with"};
+const int KEYWORD_COUNT = sizeof(KEYWORD_NAMES) / sizeof(KEYWORD_NAMES[0]);
+const size_t MIN_KEYWORD_LENGTH = 2;
+const size_t MAX_KEYWORD_LENGTH = 9;
+const int KEYWORD_BUCKETS = 16; // first-level buckets, indexed by the top 4 hash bits
+const int MAX_DISPLACEMENT = 1 << 16;
+
+//----------------------------------------------------------------------
+// Keyword lookup through a minimal perfect hash built at compile time.
+// A word is folded to lower case and packed into two integers (up to
+// MAX_KEYWORD_LENGTH bytes), which are hashed once. The top bits pick a
+// bucket whose displacement moves the low bits to one of KEYWORD_COUNT
+// slots. The slot holds the packed keyword, so one pair of integer
+// compares confirms a hit or rejects a miss without a string compare.
+//----------------------------------------------------------------------
+struct PackedWord {
+	uint64_t lo;
+	uint64_t hi;
+};
+
+// OR-ing 0x20 lowercases A-Z; no other byte can become a-z that way
+constexpr PackedWord packWord(string_view word) {
+	PackedWord packed = {0, 0};
+	for (size_t i = 0; i < word.size(); i++) {
+		uint64_t c = (unsigned char)(word[i] | 0x20);
+		if (i < 8) {
+			packed.lo |= c << (8 * i);
+		}
+		else {
+			packed.hi |= c << (8 * (i - 8));
+		}
+	}
+	return packed;
+}
+
+constexpr uint64_t keywordHash(PackedWord w) {
+	uint64_t h = (w.lo + w.hi * 0x9E3779B97F4A7C15ULL) * 0xFF51AFD7ED558CCDULL;
+	return h ^ (h >> 29);
+}
+
+struct KeywordTable {
+	uint16_t displacement[KEYWORD_BUCKETS];
+	PackedWord word[KEYWORD_COUNT];
+	Keyword id[KEYWORD_COUNT];
+	bool complete;
+
+	static constexpr int bucket(uint64_t h) { return h >> 60; }
+	constexpr int slot(uint64_t h) const {
+		return ((uint32_t)h ^ displacement[bucket(h)]) % KEYWORD_COUNT;
+	}
+
+	// hash and displace: fill the biggest buckets first, trying
+	// displacements until every word of the bucket lands on a free slot
+	constexpr KeywordTable() : displacement(), word(), id(), complete(true) {
+		uint64_t hash[KEYWORD_COUNT] = {};
+		int bucketSize[KEYWORD_BUCKETS] = {};
+		bool used[KEYWORD_COUNT] = {};
+		for (int k = 0; k < KEYWORD_COUNT; k++) {
+			hash[k] = keywordHash(packWord(KEYWORD_NAMES[k]));
+			bucketSize[bucket(hash[k])]++;
+			id[k] = Keyword::none;
+		}
+		for (int size = KEYWORD_COUNT; size > 0; size--) {
+			for (int b = 0; b < KEYWORD_BUCKETS; b++) {
+				if (bucketSize[b] == size && !place(b, hash, used)) {
+					complete = false;
+				}
+			}
+		}
+	}
+
+	constexpr bool place(int b, const uint64_t *hash, bool *used) {
+		for (int d = 0; d < MAX_DISPLACEMENT; d++) {
+			bool taken[KEYWORD_COUNT] = {};
+			bool fits = true;
+			for (int k = 0; k < KEYWORD_COUNT && fits; k++) {
+				if (bucket(hash[k]) == b) {
+					int s = ((uint32_t)hash[k] ^ d) % KEYWORD_COUNT;
+					fits = !used[s] && !taken[s];
+					taken[s] = true;
+				}
+			}
+			if (fits) {
+				displacement[b] = d;
+				for (int k = 0; k < KEYWORD_COUNT; k++) {
+					if (bucket(hash[k]) == b) {
+						int s = slot(hash[k]);
+						used[s] = true;
+						word[s] = packWord(KEYWORD_NAMES[k]);
+						id[s] = (Keyword)k;
+					}
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+inline constexpr KeywordTable KEYWORD_TABLE;
+
+// Keyword::none unless word is a reserved word, in any mix of case
+constexpr Keyword findKeyword(string_view word) {
+	if (word.size() < MIN_KEYWORD_LENGTH || word.size() > MAX_KEYWORD_LENGTH) {
+		return Keyword::none;
+	}
+	PackedWord packed = packWord(word);
+	int s = KEYWORD_TABLE.slot(keywordHash(packed));
+	if (KEYWORD_TABLE.word[s].lo == packed.lo && KEYWORD_TABLE.word[s].hi == packed.hi) {
+		return KEYWORD_TABLE.id[s];
+	}
+	return Keyword::none;
+}
+
+constexpr bool keywordsRoundTrip() {
+	for (int k = 0; k < KEYWORD_COUNT; k++) {
+		if (findKeyword(KEYWORD_NAMES[k]) != (Keyword)k) return false;
+	}
+	return true;
+}
+
+static_assert(KEYWORD_TABLE.complete, "no displacement places every keyword; change keywordHash");
+static_assert(keywordsRoundTrip(), "every keyword must find itself");
+static_assert(findKeyword("BeGiN") == Keyword::BEGIN, "keywords are case-insensitive");
+static_assert(findKeyword("begins") == Keyword::none, "a miss must not match a prefix");
+
+#endif
@@ -0,0 +1,115 @@
+#include "LexStats.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// in enum order, starting from the most negative value
+const char *const STATE_NAMES[STATS_STATES] = {"error", "start/end", "ident", "number",
+	"decimalpt", "floatingpoint", "character", "singlequote", "singlesymbol", "lsymbol",
+	"rsymbol", "lpar", "incomment", "commentstar"};
+const char *const CATEGORY_NAMES[STATS_CATEGORIES] = {"unknown", "invalid", "eol", "eof",
+	"whitespc", "alpha", "digit", "period", "leftpar", "rightpar", "star", "colon",
+	"lessthan", "greatthan", "equals", "quote", "sym", "other"};
+const char *const LEXCAT_NAMES[STATS_LEXCATS] = {"none", "error", "identifier", "symbol",
+	"integer", "real", "character", "keyword"};
+
+//----------------------------------------------------------------------
+// 							writeDouble
+//----------------------------------------------------------------------
+static void writeDouble(OutputWriter &out, double value, int width) {
+	char text[32];
+	snprintf(text, sizeof(text), "%*.1f", width, value);
+	out.write(text);
+}
+
+//----------------------------------------------------------------------
+// 							writeField
+//----------------------------------------------------------------------
+// name left-aligned in a field of `width` characters.
+//----------------------------------------------------------------------
+static void writeField(OutputWriter &out, const char *name, size_t width) {
+	out.write(name);
+	for (size_t i = strlen(name); i < width; i++) {
+		out.put(' ');
+	}
+}
+
+//----------------------------------------------------------------------
+// 							LexStats::print
+//----------------------------------------------------------------------
+void LexStats::print(OutputWriter &out) const {
+	const char *format = getenv("LEX_STATS_FORMAT");
+	if (format != NULL && strcmp(format, "json") == 0) {
+		printJson(out);
+	}
+	else {
+		printText(out);
+	}
+	out.flush();
+}
+
+//----------------------------------------------------------------------
+// 							LexStats::printText
+//----------------------------------------------------------------------
+void LexStats::printText(OutputWriter &out) const {
+	out.write("LEXEMES      count  avg length    total ms  ns/lexeme\n");
+	for (int c = 0; c < STATS_LEXCATS; c++) {
+		if (lexemes[c] == 0) continue;
+		writeField(out, LEXCAT_NAMES[c], 10);
+		out.writeInt(lexemes[c], 8);
+		writeDouble(out, (double)bytes[c] / lexemes[c], 12);
+		writeDouble(out, nanos[c] / 1e6, 12);
+		writeDouble(out, (double)nanos[c] / lexemes[c], 11);
+		out.put('\n');
+	}
+	out.write("TRANSITIONS (state, character category)\n");
+	for (int s = 0; s < STATS_STATES; s++) {
+		for (int c = 0; c < STATS_CATEGORIES; c++) {
+			if (transitions[s][c] == 0) continue;
+			writeField(out, STATE_NAMES[s], 15);
+			writeField(out, CATEGORY_NAMES[c], 11);
+			out.writeInt(transitions[s][c], 12);
+			out.put('\n');
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// 							LexStats::printJson
+//----------------------------------------------------------------------
+void LexStats::printJson(OutputWriter &out) const {
+	out.write("{\"lexemes\": [");
+	const char *separator = "";
+	for (int c = 0; c < STATS_LEXCATS; c++) {
+		if (lexemes[c] == 0) continue;
+		out.write(separator);
+		out.write("{\"category\": \"");
+		out.write(LEXCAT_NAMES[c]);
+		out.write("\", \"count\": ");
+		out.writeInt(lexemes[c]);
+		out.write(", \"bytes\": ");
+		out.writeInt(bytes[c]);
+		out.write(", \"ns\": ");
+		out.writeInt(nanos[c]);
+		out.put('}');
+		separator = ", ";
+	}
+	out.write("], \"transitions\": [");
+	separator = "";
+	for (int s = 0; s < STATS_STATES; s++) {
+		for (int c = 0; c < STATS_CATEGORIES; c++) {
+			if (transitions[s][c] == 0) continue;
+			out.write(separator);
+			out.write("{\"state\": \"");
+			out.write(STATE_NAMES[s]);
+			out.write("\", \"category\": \"");
+			out.write(CATEGORY_NAMES[c]);
+			out.write("\", \"count\": ");
+			out.writeInt(transitions[s][c]);
+			out.put('}');
+			separator = ", ";
+		}
+	}
+	out.write("]}\n");
+}
@@ -0,0 +1,45 @@
+#ifndef LEXSTATS_H
+#define LEXSTATS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "OutputWriter.h"
+
+// Sizes of ScannerState, CharCat and LexCat, each shifted so that its
+// most negative value is index 0 (see the name tables in LexStats.cpp).
+const int STATS_STATES = 14;
+const int STATS_CATEGORIES = 18;
+const int STATS_LEXCATS = 8;
+
+// Counters for a scanner built with -DLEX_STATS (make STATS=1). Without
+// it LEX_STAT() compiles to nothing and LexAnalyzer has no LexStats
+// member, so a normal build pays nothing.
+//   transitions  characters consumed, by FSM state and character category
+//   lexemes      lexemes of each LexCat (LexCat::none counts comments)
+//   bytes        total source length of those lexemes
+//   nanos        time spent producing them, leading whitespace included
+struct LexStats {
+	uint64_t transitions[STATS_STATES][STATS_CATEGORIES] = {};
+	uint64_t lexemes[STATS_LEXCATS] = {};
+	uint64_t bytes[STATS_LEXCATS] = {};
+	uint64_t nanos[STATS_LEXCATS] = {};
+
+	void transition(int state, int category) { transitions[state][category]++; }
+	void lexeme(int lexCat, size_t length, uint64_t ns) {
+		lexemes[lexCat]++;
+		bytes[lexCat] += length;
+		nanos[lexCat] += ns;
+	}
+	// LEX_STATS_FORMAT=json in the environment picks JSON over text
+	void print(OutputWriter &out) const;
+	void printText(OutputWriter &out) const;
+	void printJson(OutputWriter &out) const;
+}; // LexStats
+
+#ifdef LEX_STATS
+#define LEX_STAT(x) x
+#else
+#define LEX_STAT(x)
+#endif
+
+#endif
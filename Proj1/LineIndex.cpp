@@ -0,0 +1,166 @@
+#include "LineIndex.h"
+#include "ScanKernels.h"
+
+#include <algorithm>
+
+//----------------------------------------------------------------------
+// 							LineIndex::reset
+//----------------------------------------------------------------------
+void LineIndex::reset(string_view text, size_t from, size_t to, int firstLine,
+		int firstColumn) {
+	this->text = text.substr(0, min(to, text.size()));
+	base = 0;
+	this->from = min(from, this->text.size());
+	this->firstLine = firstLine;
+	this->firstColumn = firstColumn;
+	breaks.clear();
+	built = false;
+	windowSize = 0;
+	blockStart = 0;
+	passed = 0;
+	scanned = this->from;
+	breaksPassed = 0;
+	lastBreak = 0;
+	counted = this->from;
+	continuations = 0;
+	asciiEnd = this->from;
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::build
+//----------------------------------------------------------------------
+// Collects the offset of every CC_EOL, LINE_SCAN_BLOCK bytes at a time
+// so the kernel's output never needs more room than the block has bytes.
+//----------------------------------------------------------------------
+void LineIndex::build() {
+	uint32_t found[LINE_SCAN_BLOCK];
+	for (size_t p = from; p < text.size(); p += LINE_SCAN_BLOCK) {
+		size_t end = min(p + LINE_SCAN_BLOCK, text.size());
+		uint32_t *last = scanKernels->lineBreaks(text.data() + p, text.data() + end, p, found);
+		breaks.insert(breaks.end(), found, last);
+	}
+	built = true;
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::scanBlock
+//----------------------------------------------------------------------
+// Replaces window with the breaks of the next LINE_SCAN_BLOCK bytes.
+//----------------------------------------------------------------------
+void LineIndex::scanBlock() {
+	if (window.empty()) {
+		window.resize(LINE_SCAN_BLOCK);
+	}
+	size_t end = min(scanned + LINE_SCAN_BLOCK, base + text.size());
+	uint32_t *last = scanKernels->lineBreaks(text.data() + (scanned - base),
+		text.data() + (end - base), 0, window.data());
+	windowSize = last - window.data();
+	blockStart = scanned;
+	passed = 0;
+	scanned = end;
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::countTo
+//----------------------------------------------------------------------
+// Adds the continuation bytes in [counted, offset) to continuations.
+//----------------------------------------------------------------------
+void LineIndex::countTo(size_t offset) {
+	offset = min(offset, base + text.size());
+	while (counted < offset) {
+		if (counted >= asciiEnd) {
+			const char *p = text.data() + (counted - base);
+			if ((signed char)*p < 0) {
+				continuations += ((unsigned char)*p & 0xc0) == 0x80;
+				counted++;
+				continue;
+			}
+			const char *end = text.data() + min(text.size(), counted - base + LINE_SCAN_BLOCK);
+			asciiEnd = base + (scanKernels->asciiRun(p, end) - text.data());
+		}
+		counted = min(offset, asciiEnd);
+	}
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::at
+//----------------------------------------------------------------------
+// Position of offset, given that `before` breaks are at or before it,
+// the last of them at lastBreak, and that the line has `continuations`
+// continuation bytes before offset.
+//----------------------------------------------------------------------
+Position LineIndex::at(size_t offset, size_t before, size_t lastBreak,
+		size_t continuations) const {
+	Position pos;
+	pos.line = firstLine + before;
+	if (before > 0) {
+		pos.column = offset - lastBreak - continuations;
+	}
+	else {
+		pos.column = firstColumn + ((long)offset - (long)from) - (long)continuations;
+	}
+	return pos;
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::locate
+//----------------------------------------------------------------------
+Position LineIndex::locate(size_t offset) {
+	if (!built) {
+		build();
+	}
+	size_t before = upper_bound(breaks.begin(), breaks.end(), offset) - breaks.begin();
+	size_t lineStart = before > 0 ? breaks[before - 1] + 1 : from;
+	size_t continuations = 0;
+	const char *end = text.data() + min(offset, text.size());
+	for (const char *p = text.data() + lineStart; (p = scanKernels->asciiRun(p, end)) < end; p++) {
+		continuations += ((unsigned char)*p & 0xc0) == 0x80;
+	}
+	return at(offset, before, before > 0 ? breaks[before - 1] : 0, continuations);
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::advance
+//----------------------------------------------------------------------
+Position LineIndex::advance(size_t offset) {
+	while (true) {
+		while (passed < windowSize && blockStart + window[passed] <= offset) {
+			lastBreak = blockStart + window[passed++];
+			breaksPassed++;
+			counted = lastBreak + 1;
+			continuations = 0;
+		}
+		if (passed < windowSize || scanned > offset || scanned >= base + text.size()) {
+			break;
+		}
+		scanBlock();
+	}
+	if (offset < asciiEnd) {
+		counted = max(counted, offset);
+	}
+	else {
+		countTo(offset);
+	}
+	return at(offset, breaksPassed, lastBreak, continuations);
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::dropBefore
+//----------------------------------------------------------------------
+void LineIndex::dropBefore(size_t offset) {
+	if (offset > from) {
+		advance(offset - 1);
+		countTo(offset);
+	}
+}
+
+//----------------------------------------------------------------------
+// 							LineIndex::slide
+//----------------------------------------------------------------------
+// Bytes already scanned are not looked at again, so the new text only
+// needs to reach back to the first unscanned one.
+//----------------------------------------------------------------------
+void LineIndex::slide(string_view text, size_t base) {
+	this->text = text;
+	this->base = base;
+}
@@ -0,0 +1,80 @@
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+const size_t LINE_SCAN_BLOCK = 4096; // bytes handed to the lineBreaks kernel at a time
+
+struct Position {
+	int line;
+	int column;
+};
+
+// Line and column of any offset in text[from, to), worked out from the
+// offsets of its CC_EOL bytes instead of being counted character by
+// character. A CC_EOL belongs to the line it starts, at column 0, which
+// is how the scanner has always counted it: the byte at p is on line
+// firstLine + (breaks in [from, p]) and its column is p minus the last
+// break at or before it, less the UTF-8 continuation bytes in between,
+// so columns count code points. Continuation bytes are only looked for
+// past the end of the current ASCII run, which asciiRun finds.
+// locate() finds every break in one vectorized pass the first time it
+// is called; advance() finds them a block at a time as it goes and only
+// keeps the current block's, so it needs the same memory for any input.
+// locate()'s offsets are 32-bit, like a TokenBuffer's. advance() also
+// follows a stream, whose text is replaced by later windows of the
+// input with slide(), and takes offsets of any size.
+class LineIndex {
+	string_view text;
+	size_t base; // input offset of text[0]
+	size_t from;
+	int firstLine;
+	int firstColumn;
+	vector<uint32_t> breaks; // all of them, for locate()
+	bool built;
+	vector<uint32_t> window; // advance()'s block of breaks, relative to blockStart
+	size_t blockStart;
+	size_t windowSize;
+	size_t passed; // window entries at or before the last offset advanced to
+	size_t scanned; // end of the bytes whose breaks have been in window
+	size_t breaksPassed;
+	size_t lastBreak;
+	size_t counted; // end of the bytes advance() has looked at for columns
+	size_t continuations; // in the current line, before counted
+	size_t asciiEnd; // [counted, asciiEnd) is known to be ASCII
+
+	void build();
+	void scanBlock();
+	void countTo(size_t offset);
+	Position at(size_t offset, size_t before, size_t lastBreak, size_t continuations) const;
+public:
+	LineIndex() { reset(string_view()); }
+	// text[from] is at firstLine and firstColumn
+	explicit LineIndex(string_view text, size_t from = 0, size_t to = string_view::npos,
+		int firstLine = 1, int firstColumn = 1)
+	{
+		reset(text, from, to, firstLine, firstColumn);
+	}
+	// starts over on new text, keeping the break buffers
+	void reset(string_view text, size_t from = 0, size_t to = string_view::npos,
+		int firstLine = 1, int firstColumn = 1);
+
+	// any offset, by binary search
+	Position locate(size_t offset);
+	// for offsets that never decrease, as a scan produces them; walks
+	// forward from the last call, so a whole scan costs one pass
+	Position advance(size_t offset);
+	// for a stream: counts the breaks before offset, so the text before
+	// it can be dropped; offset must not be behind the last advance()
+	void dropBefore(size_t offset);
+	// text now holds the input from offset base on, base being at or
+	// before the last dropBefore()
+	void slide(string_view text, size_t base);
+}; // LineIndex
+
+#endif
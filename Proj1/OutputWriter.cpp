@@ -0,0 +1,135 @@
+#include "OutputWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+OutputWriter standardOutput(STDOUT_FILENO);
+OutputWriter standardError(STDERR_FILENO, &standardOutput);
+
+// enough for a 64-bit value and its sign
+const int MAX_INT_DIGITS = 21;
+
+//----------------------------------------------------------------------
+// 							OutputWriter Constructor
+//----------------------------------------------------------------------
+OutputWriter::OutputWriter(int fd, OutputWriter *tied, size_t capacity) {
+	this->fd = fd;
+	this->tied = tied;
+	buffer.resize(capacity > (size_t)MAX_INT_DIGITS ? capacity : MAX_INT_DIGITS);
+	used = 0;
+}
+
+//----------------------------------------------------------------------
+// 							OutputWriter Destructor
+//----------------------------------------------------------------------
+OutputWriter::~OutputWriter() {
+	flush();
+}
+
+//----------------------------------------------------------------------
+// 							OutputWriter::write
+//----------------------------------------------------------------------
+void OutputWriter::write(string_view text) {
+	if (tied != NULL) {
+		tied->flush();
+	}
+	if (fd == MEMORY_ONLY) {
+		reserve(text.size());
+		memcpy(buffer.data() + used, text.data(), text.size());
+		used += text.size();
+		return;
+	}
+	while (!text.empty()) {
+		size_t n = min(text.size(), buffer.size() - used);
+		memcpy(buffer.data() + used, text.data(), n);
+		used += n;
+		text.remove_prefix(n);
+		if (used == buffer.size()) {
+			flush();
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// 							OutputWriter::put
+//----------------------------------------------------------------------
+void OutputWriter::put(char c) {
+	if (tied != NULL) {
+		tied->flush();
+	}
+	reserve(1);
+	buffer[used++] = c;
+}
+
+//----------------------------------------------------------------------
+// 							OutputWriter::writeInt
+//----------------------------------------------------------------------
+// Digits are produced backwards into a scratch array, then copied
+// into the buffer after the padding.
+//----------------------------------------------------------------------
+void OutputWriter::writeInt(long value, int width) {
+	if (tied != NULL) {
+		tied->flush();
+	}
+	char digits[MAX_INT_DIGITS];
+	char *p = digits + MAX_INT_DIGITS;
+	unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : value;
+	do {
+		*--p = '0' + magnitude % 10;
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (value < 0) {
+		*--p = '-';
+	}
+	size_t length = digits + MAX_INT_DIGITS - p;
+	size_t padding = width > (int)length ? width - length : 0;
+	while (padding > 0) {
+		reserve(1);
+		size_t n = min(padding, buffer.size() - used);
+		memset(buffer.data() + used, ' ', n);
+		used += n;
+		padding -= n;
+	}
+	reserve(length);
+	memcpy(buffer.data() + used, p, length);
+	used += length;
+}
+
+//----------------------------------------------------------------------
+// 							OutputWriter::makeRoom
+//----------------------------------------------------------------------
+// Frees n bytes of buffer: by writing it out, or for a MEMORY_ONLY
+// writer by growing it.
+//----------------------------------------------------------------------
+void OutputWriter::makeRoom(size_t n) {
+	if (fd == MEMORY_ONLY) {
+		buffer.resize(max(buffer.size() * 2, used + n));
+	}
+	else {
+		flush();
+	}
+}
+
+//----------------------------------------------------------------------
+// 							OutputWriter::flush
+//----------------------------------------------------------------------
+// Writes out everything buffered. Output is dropped if the descriptor
+// fails, as a failed ostream would. A MEMORY_ONLY writer keeps it.
+//----------------------------------------------------------------------
+void OutputWriter::flush() {
+	if (fd == MEMORY_ONLY) {
+		return;
+	}
+	size_t done = 0;
+	while (done < used) {
+		ssize_t n = ::write(fd, buffer.data() + done, used - done);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+		done += n;
+	}
+	used = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+const size_t WRITE_BUFFER_SIZE = 1 << 16;
+const int MEMORY_ONLY = -1; // fd of a writer that only collects text
+
+// Buffered output straight to a file descriptor. Nothing is written
+// until the buffer fills or flush() is called; integers are formatted
+// by hand. A writer can be tied to another one, which is flushed before
+// this one writes, so stdout text always lands before a later stderr
+// message. A MEMORY_ONLY writer never writes: its buffer grows and
+// contents() returns everything written since the last clear().
+class OutputWriter {
+	int fd;
+	OutputWriter *tied;
+	vector<char> buffer;
+	size_t used;
+
+	void reserve(size_t n) { if (buffer.size() - used < n) makeRoom(n); }
+	void makeRoom(size_t n);
+public:
+	OutputWriter(int fd, OutputWriter *tied = NULL, size_t capacity = WRITE_BUFFER_SIZE);
+	~OutputWriter();
+	OutputWriter(const OutputWriter &) = delete;
+	OutputWriter &operator=(const OutputWriter &) = delete;
+
+	void write(string_view text);
+	void put(char c);
+	// value right-aligned in a field of `width` characters, like setw
+	void writeInt(long value, int width = 0);
+	void flush();
+
+	string_view contents() const { return string_view(buffer.data(), used); }
+	void clear() { used = 0; }
+}; // OutputWriter
+
+// fd 1 and fd 2; standardError is tied to standardOutput
+extern OutputWriter standardOutput;
+extern OutputWriter standardError;
+
+#endif
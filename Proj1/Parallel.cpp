@@ -0,0 +1,213 @@
+#include "Parallel.h"
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+struct Chunk {
+	size_t begin;
+	size_t end;
+	bool endsInComment = false; // if it starts outside one
+	bool startsInComment = false;
+	TokenBuffer tokens;
+};
+
+//----------------------------------------------------------------------
+// 							  runParallel
+//----------------------------------------------------------------------
+// Calls work(0) .. work(n - 1) on `threads` threads, handing out
+// indices from a shared counter.
+//----------------------------------------------------------------------
+static void runParallel(size_t n, int threads, const function<void(size_t)> &work) {
+	atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t i = next++; i < n; i = next++) {
+			work(i);
+		}
+	};
+	vector<thread> pool;
+	for (int t = 1; t < threads; t++) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (thread &t : pool) {
+		t.join();
+	}
+}
+
+//----------------------------------------------------------------------
+// 							  findChar
+//----------------------------------------------------------------------
+// memchr that answers end instead of NULL.
+//----------------------------------------------------------------------
+static inline const char *findChar(const char *p, const char *end, char c) {
+	const char *found = (const char *)memchr(p, c, end - p);
+	return found ? found : end;
+}
+
+//----------------------------------------------------------------------
+// 							  endsInComment
+//----------------------------------------------------------------------
+// Follows just enough of the scanner to tell whether [p, end) finishes
+// inside a comment: a '(' '*' pair opens one outside literals, the
+// first star-paren after it closes it, and a literal runs to the next
+// quote or end of line. A doubled quote closes and reopens a literal,
+// which comes to the same thing. The next '(' and quote are remembered
+// so each is searched for with memchr only once.
+//----------------------------------------------------------------------
+static bool endsInComment(const char *p, const char *end, bool inComment) {
+	const char *paren = NULL;
+	const char *quote = NULL;
+	while (p < end) {
+		if (inComment) {
+			p = findChar(p, end, CC_STAR) + 1;
+			if (p < end && *p == CC_RIGHTPAR) {
+				inComment = false;
+				p++;
+			}
+			continue;
+		}
+		if (paren == NULL || paren < p) paren = findChar(p, end, CC_LEFTPAR);
+		if (quote == NULL || quote < p) quote = findChar(p, end, CC_QUOTE);
+		if (paren < quote) {
+			p = paren + 1;
+			if (p < end && *p == CC_STAR) {
+				inComment = true;
+				p++;
+			}
+		}
+		else if (quote < end) {
+			p = quote + 1;
+			while (p < end && *p != CC_QUOTE && *p != CC_EOL) {
+				p++;
+			}
+			p++;
+		}
+		else {
+			break;
+		}
+	}
+	return inComment;
+}
+
+//----------------------------------------------------------------------
+// 							  splitChunks
+//----------------------------------------------------------------------
+// Cuts source into pieces of about `target` bytes, each ending just
+// after a CC_EOL (or at the end of the input).
+//----------------------------------------------------------------------
+static vector<Chunk> splitChunks(string_view source, size_t target) {
+	vector<Chunk> chunks;
+	size_t begin = 0;
+	while (begin < source.size()) {
+		size_t end = begin + target;
+		if (end >= source.size()) {
+			end = source.size();
+		}
+		else {
+			const char *eol = (const char *)memchr(source.data() + end, CC_EOL, source.size() - end);
+			end = eol ? eol - source.data() + 1 : source.size();
+		}
+		Chunk chunk;
+		chunk.begin = begin;
+		chunk.end = end;
+		chunks.push_back(chunk);
+		begin = end;
+	}
+	return chunks;
+}
+
+//----------------------------------------------------------------------
+// 							  tokenizeParallel
+//----------------------------------------------------------------------
+TokenBuffer tokenizeParallel(string_view source, int threads) {
+	if (threads <= 1) {
+		return LexAnalyzer(source).tokenize();
+	}
+	size_t target = max(MIN_CHUNK_SIZE, source.size() / (threads * CHUNKS_PER_THREAD) + 1);
+	vector<Chunk> chunks = splitChunks(source, target);
+	if (chunks.size() <= 1) {
+		return LexAnalyzer(source).tokenize();
+	}
+
+	// pre-pass: each chunk's comment state at its end assuming it starts
+	// outside a comment, then one sequential walk to chain them. The few
+	// chunks that really start inside a comment are redone there.
+	runParallel(chunks.size(), threads, [&](size_t i) {
+		Chunk &c = chunks[i];
+		const char *p = source.data() + c.begin;
+		const char *end = source.data() + c.end;
+		c.endsInComment = endsInComment(p, end, false);
+	});
+	bool inComment = false;
+	for (Chunk &c : chunks) {
+		c.startsInComment = inComment;
+		if (inComment) {
+			inComment = endsInComment(source.data() + c.begin, source.data() + c.end, true);
+		}
+		else {
+			inComment = c.endsInComment;
+		}
+	}
+
+	runParallel(chunks.size(), threads, [&](size_t i) {
+		Chunk &c = chunks[i];
+		LexAnalyzer lex(source, c.begin, c.end);
+		if (c.startsInComment) {
+			lex.startInComment();
+		}
+		c.tokens = lex.tokenize();
+	});
+
+	// decide how much of each chunk survives, stopping where the serial
+	// scan would have stopped
+	TokenBuffer tokens;
+	tokens.source = source;
+	vector<size_t> keep(chunks.size(), 0);
+	vector<size_t> start(chunks.size(), 0);
+	size_t total = 0;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		const Chunk &c = chunks[i];
+		const TokenBuffer &part = c.tokens;
+		bool last = i + 1 == chunks.size();
+		start[i] = total;
+		keep[i] = part.size();
+		// a comment running past the cut looks unterminated to this chunk
+		bool cutComment = !last && part.error == LexError::commentEnd && part.eofOffset == c.end;
+		if (cutComment) {
+			keep[i]--;
+		}
+		total += keep[i];
+		// the end of a chunk only counts as end of file for the last one;
+		// earlier it can only be a 0xff byte
+		bool realEof = part.eofToken != SIZE_MAX && (last || part.eofOffset < c.end);
+		if (realEof) {
+			tokens.eofToken = start[i] + part.eofToken;
+			tokens.eofOffset = part.eofOffset;
+		}
+		if (!cutComment && part.error != LexError::none) {
+			tokens.error = part.error;
+			tokens.errorPosition = part.errorPosition;
+			break;
+		}
+		if (realEof) {
+			break;
+		}
+	}
+
+	tokens.kind.resize(total);
+	tokens.offset.resize(total);
+	tokens.length.resize(total);
+	tokens.value.resize(total);
+	runParallel(chunks.size(), threads, [&](size_t i) {
+		const TokenBuffer &part = chunks[i].tokens;
+		size_t n = keep[i];
+		copy_n(part.kind.begin(), n, tokens.kind.begin() + start[i]);
+		copy_n(part.offset.begin(), n, tokens.offset.begin() + start[i]);
+		copy_n(part.length.begin(), n, tokens.length.begin() + start[i]);
+		copy_n(part.value.begin(), n, tokens.value.begin() + start[i]);
+		chunks[i].tokens = TokenBuffer();
+	});
+	return tokens;
+}
@@ -0,0 +1,16 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "Proj1.h"
+
+const size_t MIN_CHUNK_SIZE = 1 << 16;
+const int CHUNKS_PER_THREAD = 4;
+
+// Lexes source on `threads` threads. The input is cut into chunks that
+// start at line beginnings; a quick parallel pre-pass works out which
+// chunks open inside a (* *) comment, each chunk is lexed with its own
+// LexAnalyzer, and the pieces are joined in order. The result is the
+// same TokenBuffer that LexAnalyzer(source).tokenize() returns.
+TokenBuffer tokenizeParallel(string_view source, int threads);
+
+#endif
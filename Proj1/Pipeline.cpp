@@ -0,0 +1,64 @@
+#include "Pipeline.h"
+
+#include <thread>
+
+//----------------------------------------------------------------------
+// 							  runPipeline
+//----------------------------------------------------------------------
+// Comments are not passed on unless they carry the end of file mark.
+// While the consumer works on a batch, the ring and the scanner's own
+// batch hold at most the ring's capacity and PIPELINE_BATCH entries
+// after it, so a literal copied more entries back than that has been
+// consumed: the analyzer reuses those copies rather than keep every
+// one to the end.
+//----------------------------------------------------------------------
+void runPipeline(LexAnalyzer &lex, const function<void(const PipelineEntry *, size_t)> &consume) {
+	SpscRing<PipelineEntry> ring(PIPELINE_CAPACITY);
+	lex.keepLiterals(ring.capacity() + 2 * PIPELINE_BATCH);
+	thread scanner([&]() {
+		PipelineEntry batch[PIPELINE_BATCH];
+		size_t n = 0;
+		while (!lex.finished()) {
+			PipelineEntry &entry = batch[n];
+			entry.lexeme = lex.getNextLexeme();
+			entry.endOfFile = lex.endOfFile();
+			if (entry.lexeme.getType() == LexCat::none && !entry.endOfFile) {
+				continue;
+			}
+			if (++n == PIPELINE_BATCH) {
+				ring.push(batch, n);
+				n = 0;
+			}
+		}
+		ring.push(batch, n);
+		ring.close();
+	});
+	PipelineEntry batch[PIPELINE_BATCH];
+	while (size_t n = ring.pop(batch, PIPELINE_BATCH)) {
+		consume(batch, n);
+	}
+	scanner.join();
+	lex.keepLiterals(0);
+}
+
+//----------------------------------------------------------------------
+// 							  analyzePipelined
+//----------------------------------------------------------------------
+LexError analyzePipelined(LexAnalyzer &lex, OutputWriter &out, OutputWriter &err) {
+	LexError error = LexError::none;
+	runPipeline(lex, [&](const PipelineEntry *batch, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			const Lexeme &lexeme = batch[i].lexeme;
+			if (batch[i].endOfFile) {
+				out.write("END OF FILE\n");
+			}
+			if (lexeme.getType() != LexCat::none) {
+				lexeme.print(out, err);
+			}
+			error = lexeme.getError();
+		}
+	});
+	out.flush();
+	LEX_STAT(lex.getStats().print(err);)
+	return error;
+}
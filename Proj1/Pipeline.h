@@ -0,0 +1,33 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Proj1.h"
+#include "SpscRing.h"
+
+#include <functional>
+
+const size_t PIPELINE_CAPACITY = 4096; // lexemes in flight between the stages
+const size_t PIPELINE_BATCH = 64; // lexemes handed over at a time
+
+// One lexeme on its way through the pipeline. endOfFile marks the one
+// whose scan reached the end of the input: END OF FILE is listed just
+// before it, and it may have no token of its own (LexCat::none).
+struct PipelineEntry {
+	Lexeme lexeme;
+	bool endOfFile = false;
+};
+
+// Runs the scanner on a thread of its own, handing lexemes through an
+// SpscRing in batches of PIPELINE_BATCH, while the calling thread
+// consumes them: consume(batch, n) gets each batch in order. The
+// scanner blocks when PIPELINE_CAPACITY lexemes are waiting. A body is
+// valid until consume returns, as the analyzer reuses its literal
+// copies once they are consumed.
+void runPipeline(LexAnalyzer &lex, const function<void(const PipelineEntry *, size_t)> &consume);
+
+// LexAnalyzer::analyze split into a scanning and a printing stage, with
+// the same output; returns the error that stopped the scan, if any
+LexError analyzePipelined(LexAnalyzer &lex, OutputWriter &out = standardOutput,
+	OutputWriter &err = standardError);
+
+#endif
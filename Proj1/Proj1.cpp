@@ -1,101 +1,300 @@
 #include "Proj1.h"
 
+#include <charconv>
+#include <cstring>
+
+#ifdef LEX_STATS
+#include <chrono>
+#endif
+
 //----------------------------------------------------------------------
 // 							Lexeme Constructor
 //----------------------------------------------------------------------
 Lexeme::Lexeme() {
-	body = "";
+	offset = 0;
+	position = 0;
 	line = 0;
 	column = 0;
 	type = LexCat::none;
-	errorMessage = "";
+	keyword = Keyword::none;
+	error = LexError::none;
+	ref = NULL;
+	value.integer = 0;
+	overflow = false;
 }
 
 //----------------------------------------------------------------------
-// 							Lexeme::print
+// 							  printEntry
 //----------------------------------------------------------------------
-// Outputs formatted lexeme information to stdout (or stderr for errors)
+// The one place the listing format lives: tokens to out, errors to err.
+// An error is flushed at once, after everything listed before it.
 //----------------------------------------------------------------------
-void Lexeme::print() {
+static void printEntry(OutputWriter &out, OutputWriter &err, int line, int column,
+		LexCat type, string_view body, LexError error) {
 	if (type != LexCat::error) {
-		cout << setw(STRWIDTH) << line << setw(STRWIDTH) << column << setw(STRWIDTH)
-		 	<< (int)type << "\t" << body << endl;
+		out.writeInt(line, STRWIDTH);
+		out.writeInt(column, STRWIDTH);
+		out.writeInt((int)type, STRWIDTH);
+		out.put('\t');
+		out.write(body);
+		out.put('\n');
 	}
 	else {
-		cerr << setw(STRWIDTH) << line << setw(STRWIDTH) << column << "\t"
-			<< "Error: " << errorMessage << endl;
+		out.flush();
+		err.writeInt(line, STRWIDTH);
+		err.writeInt(column, STRWIDTH);
+		err.write("\tError: ");
+		err.write(errorString(error));
+		err.put('\n');
+		err.flush();
 	}
 }
 
 //----------------------------------------------------------------------
-// 							LexAnalyzer Constructor
+// 							Lexeme::print
+//----------------------------------------------------------------------
+// Outputs formatted lexeme information to out (or err for errors)
+//----------------------------------------------------------------------
+void Lexeme::print(OutputWriter &out, OutputWriter &err) const {
+	printEntry(out, err, line, column, type, body, error);
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer Constructors
 //----------------------------------------------------------------------
+LexAnalyzer::LexAnalyzer() {
+	strings = NULL;
+	literalsKept = 0;
+	open(string_view());
+}
+
 LexAnalyzer::LexAnalyzer(string filename) {
-	currentLine = 1;
-	currentColumn = 0;
+	strings = NULL;
+	literalsKept = 0;
+	open(filename);
+}
+
+LexAnalyzer::LexAnalyzer(string_view text, size_t from, size_t to, int firstLine,
+		int firstColumn) {
+	strings = NULL;
+	literalsKept = 0;
+	reset(text, from, min(to, text.size()), firstLine, firstColumn);
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::open
+//----------------------------------------------------------------------
+// Starts over on a file, reusing the analyzer's buffers. Returns false,
+// leaving the analyzer with empty input, if the file cannot be read.
+//----------------------------------------------------------------------
+bool LexAnalyzer::open(const string &filename) {
+	stream.close();
+	bool ok = input.open(filename);
+	reset(string_view(input.begin(), input.size()), 0, input.size(), 1, 1);
+	return ok;
+}
+
+void LexAnalyzer::open(string_view text) {
+	stream.close();
+	input.close();
+	reset(text, 0, text.size(), 1, 1);
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::openStream
+//----------------------------------------------------------------------
+// The stream's first window becomes the source; refill() slides it.
+//----------------------------------------------------------------------
+void LexAnalyzer::openStream(int fd) {
+	input.close();
+	stream.open(fd);
+	reset(string_view(stream.begin(), stream.size()), 0, stream.size(), 1, 1);
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::reset
+//----------------------------------------------------------------------
+// Starts a fresh scan of text[from, to). Offsets are still measured
+// from the start of text.
+//----------------------------------------------------------------------
+void LexAnalyzer::reset(string_view text, size_t from, size_t to, int firstLine,
+		int firstColumn) {
 	currentChar = UNSET;
 	currentCategory = CharCat::unknown;
 	state = ScannerState::end;
 	end_of_file = false;
-	file.open(filename.c_str());
-	if (!file.is_open()) {
-		cerr << "File read error\n";
-		exit(1);
-	}
+	source = text;
+	sourceBase = 0;
+	cursor = text.data() + from;
+	limit = text.data() + to;
+	lexemeStart = NO_LEXEME;
+	pastLimit = false;
+	resumeComment = false;
+	badChar = false;
+	lines.reset(text, from, to, firstLine, firstColumn);
+	literalPool.clear();
+	LEX_STAT(stats = LexStats();)
 }
 
 //----------------------------------------------------------------------
 // 							LexAnalyzer::analyze
 //----------------------------------------------------------------------
 // Calls getNextLexeme repeatedly, printing each successive lexeme.
+// Nothing printed is needed again, so literal copies are dropped as
+// they go and a stream is listed in bounded memory.
 //----------------------------------------------------------------------
-void LexAnalyzer::analyze() {
+LexError LexAnalyzer::analyze(OutputWriter &out, OutputWriter &err) {
 	Lexeme lex;
 	do {
 		lex = getNextLexeme();
+		if (end_of_file) {
+			out.write("END OF FILE\n");
+		}
 		if (lex.type != LexCat::none) {
-			lex.print();
+			lex.print(out, err);
+		}
+		if (!literalPool.empty()) {
+			literalPool.clear();
 		}
-	} while(!end_of_file && state != ScannerState::error);
+	} while(!finished());
+	out.flush();
+	LEX_STAT(stats.print(err);)
+	return lex.error;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::tokenize
+//----------------------------------------------------------------------
+// Lexes everything left in the input into a TokenBuffer.
+//----------------------------------------------------------------------
+TokenBuffer LexAnalyzer::tokenize() {
+	TokenBuffer tokens;
+	tokens.source = source;
+	tokens.reserve((limit - cursor) / TOKEN_SIZE_ESTIMATE + 1);
+	while (!finished()) {
+		tokenizeNext(tokens);
+	}
+	return tokens;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::tokenizeNext
+//----------------------------------------------------------------------
+void LexAnalyzer::tokenizeNext(TokenBuffer &tokens) {
+	Lexeme lex = scanNext();
+	if (end_of_file && tokens.eofToken == SIZE_MAX) {
+		tokens.eofToken = tokens.size();
+		tokens.eofOffset = offsetOf(charPosition());
+	}
+	if (lex.type != LexCat::none) {
+		tokens.push(lex, offsetOf(charPosition()) - lex.offset);
+	}
 }
 
 //----------------------------------------------------------------------
 // 							LexAnalyzer::getNextLexeme
 //----------------------------------------------------------------------
-// Starting function for the FSM. Returns the next lexeme in the file
-// along with all relevant information (type, line/col #)
+// Returns the next lexeme in the file along with all relevant
+// information (type, line/col #). The scan itself only tracks offsets;
+// the line and column come from the line index, whose cursor moves
+// forward with the lexemes.
 //----------------------------------------------------------------------
 Lexeme LexAnalyzer::getNextLexeme() {
+	Lexeme lex = scanNext();
+	if (lex.type != LexCat::none) {
+		Position at = lines.advance(lex.position);
+		lex.line = at.line;
+		lex.column = at.column;
+	}
+	return lex;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::lexemes
+//----------------------------------------------------------------------
+// getNextLexeme as a coroutine. Literal copies made for one lexeme are
+// dropped when the next is asked for.
+//----------------------------------------------------------------------
+Generator<Lexeme> LexAnalyzer::lexemes() {
+	while (!finished()) {
+		Lexeme lex = getNextLexeme();
+		if (lex.type != LexCat::none) {
+			co_yield lex;
+			literalPool.clear();
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::scanNext
+//----------------------------------------------------------------------
+// Starting function for the FSM. Returns the next lexeme with its
+// offsets but no line or column.
+//----------------------------------------------------------------------
+Lexeme LexAnalyzer::scanNext() {
 	Lexeme lex;
 	if (state == ScannerState::error || end_of_file)
 		return lex;
 	else
 		state = ScannerState::start;
+	LEX_STAT(auto started = chrono::steady_clock::now();)
+	scanLexeme(lex);
+	if (badChar) { // whatever was being built is dropped
+		lex = Lexeme();
+		lex.type = LexCat::error;
+		lex.error = LexError::unrecognizedChar;
+		lex.offset = offsetOf(charPosition());
+		lex.position = lex.offset;
+		state = ScannerState::error;
+	}
+	LEX_STAT(stats.lexeme((int)lex.type + 2,
+		lex.type == LexCat::none ? 0 : offsetOf(charPosition()) - lex.offset,
+		chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started).count());)
+	return lex;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::scanLexeme
+//----------------------------------------------------------------------
+// Skips whitespace and dispatches on the first character of a lexeme.
+//----------------------------------------------------------------------
+void LexAnalyzer::scanLexeme(Lexeme &lex) {
 	if (currentChar == UNSET) {
 		getNextChar();
 	}
+	if (resumeComment) { // the range starts part way through a comment
+		resumeComment = false;
+		lex.offset = offsetOf(charPosition());
+		lex.position = lex.offset;
+		state = ScannerState::incomment;
+		lex.type = LexCat::none;
+		skipComment(lex);
+		return;
+	}
 	char first = currentChar;
 	CharCat firstCategory = categorizeChar(first);
 	// ignore whitespace at start of lexeme
-	if (firstCategory == CharCat::eol || firstCategory == CharCat::whitespc) {
-		do {
-			getNextChar();
-			first = currentChar;
-			firstCategory = categorizeChar(currentChar);
-		} while(firstCategory == CharCat::eol || firstCategory == CharCat::whitespc);
+	while (firstCategory == CharCat::eol || firstCategory == CharCat::whitespc) {
+		if (firstCategory == CharCat::whitespc) {
+			skipRun(scanKernels->blankRun);
+		}
+		getNextChar();
+		first = currentChar;
+		firstCategory = categorizeChar(currentChar);
 	}
 	if (end_of_file) {
-		return lex;
+		return;
 	}
 	if (firstCategory == CharCat::invalid || firstCategory == CharCat::other) {
-		lex.line = currentLine;
-		lex.column = currentColumn;
-		return lex;
+		if (!badChar) {
+			markBadChar();
+		}
+		return;
 	}
 	else { // valid start
-		lex.body += first;
-		lex.line = currentLine;
-		lex.column = currentColumn;
+		lex.offset = offsetOf(charPosition());
+		lex.position = lex.offset;
+		lexemeStart = lex.offset;
 		if (firstCategory == CharCat::alpha) {
 			state = ScannerState::ident;
 			handleAlpha(lex);
@@ -122,70 +321,215 @@ Lexeme LexAnalyzer::getNextLexeme() {
 			state = ScannerState::singlesymbol;
 			handleSymbol(lex);
 		}
+		// a comment has no body, and from a stream its start may be gone
+		if (lex.body.data() == NULL && lex.type != LexCat::none && lex.error != LexError::commentEnd) {
+			const char *start = pointerAt(lex.offset);
+			lex.body = string_view(start, charPosition() - start);
+		}
+		lexemeStart = NO_LEXEME;
 	}
-	return lex;
 }
 
 //----------------------------------------------------------------------
 // 							LexAnalyzer::handleAlpha
 //----------------------------------------------------------------------
-// Continues the FSM from the start state for identifiers
+// Continues the FSM from the start state for identifiers, then checks
+// the finished word against the reserved words. When interning, the
+// run is walked by hashIdentifier, which with an IncrementalHash reads
+// the word once to find its end and hash it for the table.
 //----------------------------------------------------------------------
 void LexAnalyzer::handleAlpha(Lexeme &lex) {
-	lex.type = LexCat::identifier;
+	uint64_t hashVal = 0;
+	if (strings == NULL) {
+		skipRun(scanKernels->identRun);
+	}
+	else {
+		hashVal = hashIdentifier<StringTable::hasher>();
+	}
 	getNextChar();
-	while(currentCategory == CharCat::digit || currentCategory == CharCat::alpha) {
-		state = ScannerState::ident;
-		lex.body += currentChar;
-		getNextChar();
+	const char *start = pointerAt(lex.offset);
+	string_view word(start, charPosition() - start);
+	lex.keyword = findKeyword(word);
+	lex.type = lex.keyword == Keyword::none ? LexCat::identifier : LexCat::keyword;
+	if (strings != NULL && lex.type == LexCat::identifier) {
+		lex.ref = strings->insert(word, hashVal);
 	}
 	state = ScannerState::end;
 	return;
 }
 
+//----------------------------------------------------------------------
+// 							  nonIdentBytes
+//----------------------------------------------------------------------
+// The high bit of each byte of word, 8 characters loaded little-endian,
+// that is not a letter or digit: each range test adds a constant that
+// carries into a byte's high bit from the range's first character on,
+// and no byte can carry into the next once its own high bit is masked.
+//----------------------------------------------------------------------
+static inline uint64_t nonIdentBytes(uint64_t word) {
+	const uint64_t ONES = 0x0101010101010101ull;
+	const uint64_t HIGH = 0x8080808080808080ull;
+	uint64_t ascii = word & ~HIGH;
+	uint64_t lower = ascii | 0x20 * ONES; // A-Z onto a-z, nothing else into it
+	uint64_t letter = (lower + (0x80 - 'a') * ONES) & ~(lower + (0x7f - 'z') * ONES);
+	uint64_t digit = (ascii + (0x80 - '0') * ONES) & ~(ascii + (0x7f - '9') * ONES);
+	return ~((letter | digit) & ~word) & HIGH;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::hashIdentifier
+//----------------------------------------------------------------------
+// Consumes the identifier run after currentChar like skipRun, 8 bytes
+// at a time: each load is both classified and, while all of it is
+// letters and digits, fed to the table's hash, so the whole word is
+// hashed by the time its end is found. Returns that hash. Only the last
+// few bytes of the input are copied to be loaded; a stream's window is
+// refilled if the run reaches its end. A Hash without the word-at-a-time
+// interface hashes the word once identRun has found its end.
+//----------------------------------------------------------------------
+template <class Hash>
+uint64_t LexAnalyzer::hashIdentifier() {
+	if constexpr (IncrementalHash<Hash>) {
+		const char *p = cursor - 1; // currentChar, the first letter
+		size_t length = 0;
+		uint64_t h = Hash::start();
+		while (true) {
+			size_t available = limit - p;
+			uint64_t word = 0;
+			uint64_t stops;
+			if (available >= 8) {
+				memcpy(&word, p, 8);
+				stops = nonIdentBytes(word);
+			}
+			else {
+				memcpy(&word, p, available);
+				stops = nonIdentBytes(word) | 0x8080808080808080ull << (8 * available);
+			}
+			if (stops == 0) {
+				h = Hash::step(h, word);
+				p += 8;
+				length += 8;
+				continue;
+			}
+			size_t n = __builtin_ctzll(stops) / 8;
+			if (n == available) { // the run may go on past the window
+				size_t at = offsetOf(p);
+				if (refill(cursor - 1)) {
+					p = pointerAt(at);
+					continue;
+				}
+			}
+			uint64_t tail = n == 0 ? 0 : word & (~0ull >> (64 - 8 * n));
+			LEX_STAT(countRun(cursor, p + n);)
+			cursor = p + n;
+			return Hash::finish(h, tail, length + n);
+		}
+	}
+	else {
+		size_t from = offsetOf(cursor - 1);
+		skipRun(scanKernels->identRun);
+		const char *start = pointerAt(from);
+		return Hash::hash(string_view(start, cursor - start));
+	}
+}
+
+//----------------------------------------------------------------------
+// 							  parseInteger
+//----------------------------------------------------------------------
+// Value of the digits [p, end). The first SAFE_DIGITS cannot overflow
+// and skip the checks; past that an overflow gives INT64_MAX.
+//----------------------------------------------------------------------
+int64_t parseInteger(const char *p, const char *end, bool &overflow) {
+	int64_t value = 0;
+	const char *safeEnd = p + min<ptrdiff_t>(end - p, SAFE_DIGITS);
+	for (; p < safeEnd; p++) {
+		value = value * 10 + (*p - '0');
+	}
+	overflow = false;
+	for (; p < end; p++) {
+		if (__builtin_mul_overflow(value, 10, &value)
+			|| __builtin_add_overflow(value, *p - '0', &value))
+		{
+			overflow = true;
+			return INT64_MAX;
+		}
+	}
+	return value;
+}
+
+//----------------------------------------------------------------------
+// 							  parseReal
+//----------------------------------------------------------------------
+// Value of a real literal "digits.digits", correctly rounded. When the
+// digits fit in a double's mantissa and the divisor 10^k is exact, one
+// division is already correctly rounded (Clinger's fast path);
+// anything longer goes to from_chars.
+//----------------------------------------------------------------------
+double parseReal(const char *p, const char *end) {
+	static const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+		1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	const int MAX_EXACT_POWER = 22;
+	if (end - p <= SAFE_DIGITS + 1) {
+		uint64_t mantissa = 0;
+		int fraction = -1;
+		for (const char *q = p; q < end; q++) {
+			if (*q == CC_PERIOD) {
+				fraction = 0;
+			}
+			else {
+				mantissa = mantissa * 10 + (*q - '0');
+				fraction += fraction >= 0;
+			}
+		}
+		if (mantissa <= (1ULL << 53) && fraction <= MAX_EXACT_POWER) {
+			return (double)mantissa / POWERS_OF_TEN[fraction];
+		}
+	}
+	double value = 0;
+	from_chars(p, end, value);
+	return value;
+}
+
 //----------------------------------------------------------------------
 // 							LexAnalyzer::handleNumber
 //----------------------------------------------------------------------
 // Continues the FSM from the start state for numbers (floats and ints)
 //----------------------------------------------------------------------
 void LexAnalyzer::handleNumber(Lexeme &lex) {
+	skipRun(scanKernels->digitRun);
 	getNextChar();
-	while(currentCategory == CharCat::digit) {
-		lex.body += currentChar;
-		getNextChar();
-	}
 	if (currentCategory == CharCat::period) { // 123.
 		state = ScannerState::decimalpt;
-		char next = file.peek(); // for the case of 123..
+		char next = peekChar(); // for the case of 123..
 		currentCategory = categorizeChar(next);
 		if (currentCategory == CharCat::period) {
 			lex.type = LexCat::integer;
+			lex.value.integer = parseInteger(pointerAt(lex.offset), charPosition(), lex.overflow);
 			state = ScannerState::end; // leave period for next lexeme
 			return;
 		}
 		else { // 123.x
-			lex.body += currentChar;
 			getNextChar();
 			if (currentCategory == CharCat::digit) {
 				state = ScannerState::floatingpoint;
-				while (currentCategory == CharCat::digit) {
-					lex.body += currentChar;
-					getNextChar();
-				}
+				skipRun(scanKernels->digitRun);
+				getNextChar();
 			}
 			else {
 				lex.type = LexCat::error;
 				state = ScannerState::error;
-				lex.errorMessage = "Following Digit Expected";
+				lex.error = LexError::digitExpected;
 				return;
 			}
 		}
 	}
 	if (state == ScannerState::number) {
 		lex.type = LexCat::integer;
+		lex.value.integer = parseInteger(pointerAt(lex.offset), charPosition(), lex.overflow);
 	}
 	else if (state == ScannerState::floatingpoint) {
 		lex.type = LexCat::real;
+		lex.value.real = parseReal(pointerAt(lex.offset), charPosition());
 	}
 }
 
@@ -195,30 +539,32 @@ void LexAnalyzer::handleNumber(Lexeme &lex) {
 // Continues the FSM from the start state for character literals.
 //----------------------------------------------------------------------
 void LexAnalyzer::handleString(Lexeme &lex) {
+	bool escapedQuote = false;
 	lex.type = LexCat::character;
 	while(currentCategory != CharCat::eol && currentCategory != CharCat::eof) {
+		skipRun(scanKernels->literalRun);
 		getNextChar();
-		if (currentCategory != CharCat::eol && currentCategory != CharCat::eof
-			&& currentCategory != CharCat::quote)
-		{
-			lex.body += currentChar;
-		}
-		else if (currentCategory == CharCat::eof || currentCategory == CharCat::eol) {
+		if (currentCategory == CharCat::eof || currentCategory == CharCat::eol) {
 			lex.type = LexCat::error;
-			lex.errorMessage = "End of character literal expected";
+			lex.error = LexError::literalEnd;
 			state = ScannerState::error;
-			lex.line = currentLine;
-			lex.column = currentColumn;
+			lex.position = errorPosition();
 			return;
 		}
 		else if (currentCategory == CharCat::quote) {
-			lex.body += currentChar;
+			state = ScannerState::singlequote; // the literal may be over
 			getNextChar();
 			if (currentCategory == CharCat::quote) {
+				state = ScannerState::character;
+				escapedQuote = true;
 				continue;
 			}
 			else {
 				state = ScannerState::end;
+				if (escapedQuote) {
+					const char *start = pointerAt(lex.offset);
+					lex.body = unescapeLiteral(string_view(start, charPosition() - start));
+				}
 				return;
 			}
 		}
@@ -235,28 +581,9 @@ void LexAnalyzer::handleLPar(Lexeme &lex) {
 	if (currentCategory == CharCat::star) {
 		state = ScannerState::incomment;
 		lex.type = LexCat::none;
+		lexemeStart = NO_LEXEME; // nothing of a comment is kept
 		getNextChar();
-		while(currentCategory != CharCat::eof) {
-			if (currentCategory == CharCat::star) {
-				state = ScannerState::commentstar;
-				getNextChar();
-				if (currentCategory == CharCat::rightpar) {
-					state == ScannerState::end;
-					getNextChar();
-					return;
-				}
-				else continue;
-			}
-			getNextChar();
-		}
-		if (currentCategory == CharCat::eof) {
-			lex.type = LexCat::error;
-			lex.errorMessage = "End of Comment Expected";
-			state = ScannerState::error;
-			lex.line = currentLine;
-			lex.column = currentColumn;
-			return;
-		}
+		skipComment(lex);
 	}
 	else {
 		lex.type = LexCat::symbol;
@@ -264,6 +591,36 @@ void LexAnalyzer::handleLPar(Lexeme &lex) {
 	}
 }
 
+//----------------------------------------------------------------------
+// 							LexAnalyzer::skipComment
+//----------------------------------------------------------------------
+// Consumes a comment body, starting at currentChar, through the closing
+// star-paren.
+//----------------------------------------------------------------------
+void LexAnalyzer::skipComment(Lexeme &lex) {
+	while(currentCategory != CharCat::eof) {
+		if (currentCategory == CharCat::star) {
+			state = ScannerState::commentstar;
+			getNextChar();
+			if (currentCategory == CharCat::rightpar) {
+				state = ScannerState::end;
+				getNextChar();
+				return;
+			}
+			else continue;
+		}
+		skipRun(scanKernels->commentRun);
+		getNextChar();
+	}
+	if (currentCategory == CharCat::eof) {
+		lex.type = LexCat::error;
+		lex.error = LexError::commentEnd;
+		state = ScannerState::error;
+		lex.position = errorPosition();
+		return;
+	}
+}
+
 //----------------------------------------------------------------------
 // 							LexAnalyzer::handleLSymbol
 //----------------------------------------------------------------------
@@ -274,13 +631,11 @@ void LexAnalyzer::handleLSymbol(Lexeme &lex) {
 	if (currentCategory == CharCat::lessthan) {
 		getNextChar();
 		if (currentCategory == CharCat::greatthan) {
-			lex.body += currentChar;
 			state = ScannerState::end;
 			getNextChar();
 			return;
 		}
 		else if (currentCategory == CharCat::equals) {
-			lex.body += currentChar;
 			state = ScannerState::end;
 			getNextChar();
 			return;
@@ -293,7 +648,6 @@ void LexAnalyzer::handleLSymbol(Lexeme &lex) {
 	else if (currentCategory == CharCat::greatthan) {
 		getNextChar();
 		if (currentCategory == CharCat::equals) {
-			lex.body += currentChar;
 			state = ScannerState::end;
 			getNextChar();
 			return;
@@ -306,7 +660,6 @@ void LexAnalyzer::handleLSymbol(Lexeme &lex) {
 	else if (currentCategory == CharCat::colon) {
 		getNextChar();
 		if (currentCategory == CharCat::equals) {
-			lex.body += currentChar;
 			state = ScannerState::end;
 			getNextChar();
 			return;
@@ -319,7 +672,6 @@ void LexAnalyzer::handleLSymbol(Lexeme &lex) {
 	else if (currentCategory == CharCat::period) {
 		getNextChar();
 		if (currentCategory == CharCat::period) {
-			lex.body += currentChar;
 			state = ScannerState::end;
 			getNextChar();
 			return;
@@ -337,104 +689,252 @@ void LexAnalyzer::handleLSymbol(Lexeme &lex) {
 // Continues the FSM from the start state for single symbols.
 //----------------------------------------------------------------------
 void LexAnalyzer::handleSymbol(Lexeme &lex) {
-	state == ScannerState::end;
+	state = ScannerState::end;
 	lex.type = LexCat::symbol;
 	getNextChar();
 }
 //----------------------------------------------------------------------
 // 							LexAnalyzer::getNextChar
 //----------------------------------------------------------------------
-// updates line #, column #, currentChar, and currentCategory.
+// updates currentChar and currentCategory. Lines and columns are left
+// to the line index.
 //----------------------------------------------------------------------
 void LexAnalyzer::getNextChar() {
-	currentChar = file.get();
-	currentCategory = categorizeChar(currentChar);
-	if(currentChar == CC_EOL) {
-		currentLine += 1;
-		currentColumn = 0;
+	if (cursor < limit || refill(cursor - 1)) {
+		currentChar = *cursor++;
+	}
+	else {
+		currentChar = CC_EOF;
+		pastLimit = true;
 	}
-	else if (currentChar == CC_EOF){
-		cout << "END OF FILE" << endl;
+	currentCategory = categorizeChar(currentChar);
+	bool bad = currentCategory == CharCat::invalid && !(inText() && takeUtf8());
+	LEX_STAT(stats.transition((int)state + 1, (int)currentCategory + 2);)
+	if (currentChar == CC_EOF) {
 		end_of_file = true;
 	}
-	else {
-		currentColumn += 1;
+
+	if (bad) {
+		markBadChar();
 	}
+}
 
-	if (currentCategory == CharCat::invalid) {
-		cerr << setw(5) << currentLine << setw(5) << currentColumn <<
-			 "\t" << "Error: Unrecognized Character" << endl;
-		state = ScannerState::error;
-		exit(1);
+//----------------------------------------------------------------------
+// 							LexAnalyzer::takeUtf8
+//----------------------------------------------------------------------
+// Inside a comment or literal, a non-ASCII currentChar may begin a
+// UTF-8 character. If it is well-formed the rest of it is consumed and
+// it reads as CharCat::other; otherwise currentChar stays invalid. A
+// stream's window is refilled first, as often as it takes, if the
+// character might run past it.
+//----------------------------------------------------------------------
+bool LexAnalyzer::takeUtf8() {
+	int n = utf8Length(cursor - 1, limit);
+	while (n == 0 && limit - cursor < 3 && refill(cursor - 1)) {
+		n = utf8Length(cursor - 1, limit);
+	}
+	if (n == 0) {
+		return false;
 	}
+	cursor += n - 1;
+	currentCategory = CharCat::other;
+	return true;
 }
 
 //----------------------------------------------------------------------
-// 							LexAnalyzer::categorizeChar
+// 							LexAnalyzer::refill
 //----------------------------------------------------------------------
-// given a character, returns the CharCat category for that character
+// Slides a stream's window up to keep, the character just read, or to
+// the start of the token being scanned if that is earlier, and reads
+// more; then moves every pointer into it. Keeping the last character
+// lets an error at end of file be listed there. Lines are counted up
+// to the kept offset before the bytes before it go. Returns false if
+// nothing more was read; at the end of the stream, or without one,
+// nothing is moved either.
 //----------------------------------------------------------------------
-CharCat LexAnalyzer::categorizeChar(char c) {
-	CharCat category = CharCat::unknown;
-	switch (c) { // special symbols and cases
-		case CC_EOL: category = CharCat::eol;
-			break;
-		case CC_EOF: category = CharCat::eof;
-			break;
-		case CC_PERIOD: category = CharCat::period;
-			break;
-		case CC_LEFTPAR: category = CharCat::leftpar;
-			break;
-		case CC_RIGHTPAR: category = CharCat::rightpar;
-			break;
-		case CC_STAR: category = CharCat::star;
-			break;
-		case CC_COLON: category = CharCat::colon;
-			break;
-		case CC_LESSTHAN: category = CharCat::lessthan;
-			break;
-		case CC_GREATTHAN: category = CharCat::greatthan;
-			break;
-		case CC_EQUAL: category = CharCat::equals;
-			break;
-		case CC_QUOTE: category = CharCat::quote;
+bool LexAnalyzer::refill(const char *keep) {
+	if (stream.atEnd()) {
+		return false;
 	}
-	if (category == CharCat::unknown) {
-		if (isalpha(c)) category = CharCat::alpha;
-		else if (isdigit(c)) category = CharCat::digit;
-		else if (issymbol(c)) category = CharCat::sym;
-		else if (isspace(c)) category = CharCat::whitespc;
-		else if (c >= CC_MIN && c < CC_MAX) category = CharCat::other;
-		else category = CharCat::invalid;
+	size_t keepOffset = min(offsetOf(keep), lexemeStart);
+	size_t cursorOffset = offsetOf(cursor);
+	lines.dropBefore(keepOffset);
+	bool more = stream.refill(keepOffset);
+	source = string_view(stream.begin(), stream.size());
+	sourceBase = stream.base();
+	cursor = pointerAt(cursorOffset);
+	limit = source.data() + source.size();
+	lines.slide(source, sourceBase);
+	return more;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::markBadChar
+//----------------------------------------------------------------------
+// Records an unrecognized currentChar. Its category is then reported as
+// eof so every handler loop stops where it is; getNextLexeme turns the
+// lexeme into the error.
+//----------------------------------------------------------------------
+void LexAnalyzer::markBadChar() {
+	badChar = true;
+	currentCategory = CharCat::eof;
+}
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::skipRun
+//----------------------------------------------------------------------
+// Consumes the run of characters after currentChar that `run` accepts.
+// The next getNextChar reads the character that ended the run. A run
+// that reaches the end of a stream's window goes on after a refill.
+//----------------------------------------------------------------------
+void LexAnalyzer::skipRun(const char *(*run)(const char *, const char *)) {
+	do {
+		const char *stop = run(cursor, limit);
+		LEX_STAT(countRun(cursor, stop);)
+		cursor = stop;
+	} while (cursor == limit && refill(cursor - 1));
+}
+
+#ifdef LEX_STATS
+//----------------------------------------------------------------------
+// 							LexAnalyzer::countRun
+//----------------------------------------------------------------------
+// Counts the characters a run consumed as transitions of the current
+// state.
+//----------------------------------------------------------------------
+void LexAnalyzer::countRun(const char *from, const char *to) {
+	for (const char *p = from; p < to; p++) {
+		stats.transition((int)state + 1, (int)categorizeChar(*p) + 2);
 	}
-	return category;
+}
+#endif
+
+//----------------------------------------------------------------------
+// 							LexAnalyzer::peekChar
+//----------------------------------------------------------------------
+// returns the character after currentChar without consuming it.
+//----------------------------------------------------------------------
+char LexAnalyzer::peekChar() {
+	return (cursor < limit || refill(cursor - 1)) ? *cursor : CC_EOF;
 }
 
 //----------------------------------------------------------------------
-// 							  issymbol
+// 							  unescapeInto
 //----------------------------------------------------------------------
-// returns true if the given character is a valid symbol, false otherwise.
+// Appends a raw character literal to text with each doubled quote
+// inside it collapsed to one.
 //----------------------------------------------------------------------
-bool issymbol(char c) {
-	for (size_t i = 0; i < CC_SYMBOLS.size(); i++) {
-		if (c == CC_SYMBOLS[i]) return true;
+static void unescapeInto(string &text, string_view raw) {
+	text += raw.front();
+	for (size_t i = 1; i + 1 < raw.size(); i++) {
+		text += raw[i];
+		if (raw[i] == CC_QUOTE) i++; // skip the second quote of the pair
 	}
-	return false;
+	text += raw.back();
 }
 
 //----------------------------------------------------------------------
-// 									main
+// 							LexAnalyzer::unescapeLiteral
 //----------------------------------------------------------------------
-int main(int argc, char **argv) {
-	string filename = "";
-	if (argc > 1) {
-		filename = argv[1];
+// Collapses each doubled quote inside a raw character literal. The copy
+// is kept in literalPool so the returned view outlives the lexeme; once
+// the pool holds literalsKept copies the oldest is cleared and reused.
+//----------------------------------------------------------------------
+string_view LexAnalyzer::unescapeLiteral(string_view raw) {
+	if (literalsKept > 0 && literalPool.size() >= literalsKept) {
+		literalPool.push_back(move(literalPool.front()));
+		literalPool.pop_front();
+		literalPool.back().clear();
 	}
 	else {
-		cout << "Enter a filename: ";
-		cin >> filename;
+		literalPool.emplace_back();
+	}
+	string &text = literalPool.back();
+	text.reserve(raw.size());
+	unescapeInto(text, raw);
+	return text;
+}
+
+//----------------------------------------------------------------------
+// 							  errorString
+//----------------------------------------------------------------------
+// returns the message printed for a LexError.
+//----------------------------------------------------------------------
+const char *errorString(LexError error) {
+	switch (error) {
+		case LexError::unrecognizedChar: return "Unrecognized Character";
+		case LexError::digitExpected: return "Following Digit Expected";
+		case LexError::literalEnd: return "End of character literal expected";
+		case LexError::commentEnd: return "End of Comment Expected";
+		default: return "";
+	}
+}
+
+//----------------------------------------------------------------------
+// 							TokenBuffer::integerOverflow
+//----------------------------------------------------------------------
+bool TokenBuffer::integerOverflow(size_t i) const {
+	if (kind[i] != LexCat::integer || value[i].integer != INT64_MAX) {
+		return false;
+	}
+	bool overflow;
+	parseInteger(source.data() + offset[i], source.data() + offset[i] + length[i], overflow);
+	return overflow;
+}
+
+//----------------------------------------------------------------------
+// 							TokenBuffer::reserve
+//----------------------------------------------------------------------
+void TokenBuffer::reserve(size_t n) {
+	value.reserve(n);
+	kind.reserve(n);
+	offset.reserve(n);
+	length.reserve(n);
+}
+
+//----------------------------------------------------------------------
+// 							TokenBuffer::push
+//----------------------------------------------------------------------
+// Appends lex, whose source text is sourceLength bytes long.
+//----------------------------------------------------------------------
+void TokenBuffer::push(const Lexeme &lex, size_t sourceLength) {
+	kind.push_back(lex.type);
+	offset.push_back(lex.offset);
+	length.push_back(sourceLength);
+	value.push_back(lex.value);
+	if (lex.type == LexCat::error) {
+		error = lex.error;
+		errorPosition = lex.position;
+	}
+}
+
+//----------------------------------------------------------------------
+// 							TokenBuffer::print
+//----------------------------------------------------------------------
+// Prints the tokens exactly as LexAnalyzer::analyze would have; returns
+// the error that ended the scan, if any.
+//----------------------------------------------------------------------
+LexError TokenBuffer::print(OutputWriter &out, OutputWriter &err) const {
+	LineIndex lines(source);
+	string unescaped;
+	for (size_t i = 0; i < size(); i++) {
+		if (i == eofToken) {
+			out.write("END OF FILE\n");
+		}
+		string_view body = text(i);
+		if (kind[i] == LexCat::character && body.size() > 2
+			&& body.substr(1, body.size() - 2).find("''") != string_view::npos)
+		{
+			unescaped.clear();
+			unescapeInto(unescaped, body);
+			body = unescaped;
+		}
+		Position at = lines.advance(positionOf(i));
+		printEntry(out, err, at.line, at.column, kind[i], body, error);
+	}
+	if (eofToken == size()) {
+		out.write("END OF FILE\n");
 	}
-	LexAnalyzer lex(filename);
-	lex.analyze();
-	return 0;
+	out.flush();
+	return error;
 }
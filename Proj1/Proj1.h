@@ -1,8 +1,22 @@
+#ifndef PROJ1_H
+#define PROJ1_H
+
 #include <iostream>
 #include <string>
-#include <fstream>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <cstdint>
 #include <iomanip>
 #include <cctype>
+#include "Generator.h"
+#include "InputBuffer.h"
+#include "LineIndex.h"
+#include "Keywords.h"
+#include "OutputWriter.h"
+#include "LexStats.h"
+#include "ScanKernels.h"
+#include "../Proj2/proj2.h"
 
 using namespace std;
 
@@ -18,55 +32,289 @@ const char CC_LESSTHAN = '<';
 const char CC_GREATTHAN = '>';
 const char CC_EQUAL = '=';
 const char CC_QUOTE = '\'';
-const string CC_SYMBOLS = "+-/[],;^";
+constexpr char CC_SYMBOLS[] = "+-/[],;^";
 const char CC_MIN = ' '; // inclusive
 const char CC_MAX = '~'; // exclusive
 const int STRWIDTH = 5;
+const int TOKEN_SIZE_ESTIMATE = 4; // average source bytes per token, used to reserve
+const int SAFE_DIGITS = 18; // decimal digits that always fit in an int64_t
+const size_t NO_LEXEME = SIZE_MAX; // no token is being scanned
 
-enum class CharCat {eol, eof, whitespc, alpha, digit, period, leftpar, rightpar, star, colon, lessthan,
+enum class CharCat : signed char {eol, eof, whitespc, alpha, digit, period, leftpar, rightpar, star, colon, lessthan,
 		greatthan, equals, quote, sym, other, invalid=-1, unknown=-2};
 
-enum class LexCat {identifier, symbol, integer, real, character, error=-1, none=-2};
+//----------------------------------------------------------------------
+// Character classification table, built at compile time from the CC_*
+// constants above and indexed by unsigned byte. Letters, digits and
+// whitespace follow the "C" locale regardless of the runtime locale.
+//----------------------------------------------------------------------
+constexpr bool issymbol(char c) {
+	for (const char *s = CC_SYMBOLS; *s != '\0'; s++) {
+		if (c == *s) return true;
+	}
+	return false;
+}
+
+constexpr CharCat classifyChar(char c) {
+	switch (c) { // special symbols and cases
+		case CC_EOL: return CharCat::eol;
+		case CC_EOF: return CharCat::eof;
+		case CC_PERIOD: return CharCat::period;
+		case CC_LEFTPAR: return CharCat::leftpar;
+		case CC_RIGHTPAR: return CharCat::rightpar;
+		case CC_STAR: return CharCat::star;
+		case CC_COLON: return CharCat::colon;
+		case CC_LESSTHAN: return CharCat::lessthan;
+		case CC_GREATTHAN: return CharCat::greatthan;
+		case CC_EQUAL: return CharCat::equals;
+		case CC_QUOTE: return CharCat::quote;
+	}
+	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) return CharCat::alpha;
+	if (c >= '0' && c <= '9') return CharCat::digit;
+	if (issymbol(c)) return CharCat::sym;
+	if (c == ' ' || (c >= '\t' && c <= '\r')) return CharCat::whitespc;
+	if (c >= CC_MIN && c < CC_MAX) return CharCat::other;
+	return CharCat::invalid;
+}
+
+struct CharCatTable {
+	CharCat cat[256];
+
+	constexpr CharCatTable() : cat() {
+		for (int i = 0; i < 256; i++) {
+			cat[i] = classifyChar((char)i);
+		}
+	}
+	constexpr CharCat operator[](char c) const { return cat[(unsigned char)c]; }
+};
+
+inline constexpr CharCatTable CHAR_CATEGORIES;
+
+static_assert(CHAR_CATEGORIES[CC_EOF] == CharCat::eof, "0xff must read as end of file");
+static_assert(CHAR_CATEGORIES['~'] == CharCat::invalid, "CC_MAX is exclusive");
+
+enum class LexCat : signed char {identifier, symbol, integer, real, character, keyword, error=-1, none=-2};
+
+enum class LexError {none, unrecognizedChar, digitExpected, literalEnd, commentEnd};
+
+// a numeric literal's value: integer for LexCat::integer, real for
+// LexCat::real. An integer too large for int64_t reads as INT64_MAX.
+union TokenValue {
+	int64_t integer;
+	double real;
+};
 
 enum class ScannerState {start, ident, number, decimalpt, floatingpoint, character, singlequote, singlesymbol,
 		lsymbol, rsymbol, lpar, incomment, commentstar, error=-1, end};
 
+// LexStats indexes these enums from their most negative value
+static_assert((int)ScannerState::commentstar + 1 == STATS_STATES - 1, "LexStats state names");
+static_assert((int)CharCat::other + 2 == STATS_CATEGORIES - 1, "LexStats category names");
+static_assert((int)LexCat::keyword + 2 == STATS_LEXCATS - 1, "LexStats LexCat names");
+
+// body views the source buffer, or the analyzer's literal pool when a
+// character literal had doubled quotes; either way it lives as long as
+// the LexAnalyzer that produced it, or with a stream until the next
+// lexeme is scanned, and a pooled copy only until keepLiterals lets it
+// be reused. position is the offset whose line
+// and column the lexeme is listed at: its first character, except for
+// errors reported where the scan stopped.
 class Lexeme {
-	string body;
+	string_view body;
+	size_t offset;
+	size_t position;
 	int line;
 	int column;
 	LexCat type;
-	string errorMessage;
+	Keyword keyword;
+	LexError error;
+	StringTableRef ref;
+	TokenValue value;
+	bool overflow;
 
 	friend class LexAnalyzer;
+	friend struct TokenBuffer;
 public:
 	Lexeme();
-	void print();
+	void print(OutputWriter &out = standardOutput, OutputWriter &err = standardError) const;
+	LexCat getType() const { return type; }
+	// which reserved word a LexCat::keyword lexeme is
+	Keyword getKeyword() const { return keyword; }
+	// an identifier's StringTable entry, if the analyzer was interning
+	StringTableRef getRef() const { return ref; }
+	int64_t getInteger() const { return value.integer; }
+	double getReal() const { return value.real; }
+	// true if an integer literal did not fit in int64_t
+	bool integerOverflow() const { return overflow; }
+	string_view getBody() const { return body; }
+	size_t getOffset() const { return offset; }
+	int getLine() const { return line; }
+	int getColumn() const { return column; }
+	LexError getError() const { return error; }
 }; // Lexeme
 
+// A std::allocator whose resize() leaves new elements uninitialized, so
+// a TokenBuffer can be sized first and filled later (possibly from
+// several threads) without a zeroing pass.
+template <class T>
+struct NoInitAllocator : allocator<T> {
+	template <class U> struct rebind { typedef NoInitAllocator<U> other; };
+	NoInitAllocator() = default;
+	template <class U> NoInitAllocator(const NoInitAllocator<U> &) {}
+	template <class U> void construct(U *p) { ::new ((void *)p) U; }
+	template <class U, class... Args> void construct(U *p, Args &&... args) {
+		::new ((void *)p) U(std::forward<Args>(args)...);
+	}
+};
+
+template <class T>
+using TokenArray = vector<T, NoInitAllocator<T>>;
+
+// The whole input as parallel arrays, one entry per token (comments are
+// not tokens). offset/length give the token's source text, so a
+// character literal keeps its doubled quotes here. Lines and columns
+// are not stored: a LineIndex over source finds them from positionOf().
+// If the scan stopped on an error, the last token has kind
+// LexCat::error, `error` says why and errorPosition where it is
+// reported. Offsets are 32-bit, which limits one buffer to 4 GiB of input.
+// eofToken is the index of the token whose lexing reached end of file:
+// END OF FILE is printed just before it (size() means after the last
+// token, SIZE_MAX that the end was never reached).
+struct TokenBuffer {
+	string_view source;
+	TokenArray<LexCat> kind;
+	TokenArray<uint32_t> offset;
+	TokenArray<uint32_t> length;
+	TokenArray<TokenValue> value; // meaningful for integer and real tokens
+	LexError error = LexError::none;
+	size_t errorPosition = 0;
+	size_t eofToken = SIZE_MAX;
+	size_t eofOffset = 0;
+
+	size_t size() const { return kind.size(); }
+	string_view text(size_t i) const { return source.substr(offset[i], length[i]); }
+	// the offset token i is listed at
+	size_t positionOf(size_t i) const {
+		return kind[i] == LexCat::error ? errorPosition : offset[i];
+	}
+	// keyword ids are not stored; a lookup costs about as much as a load
+	Keyword keywordOf(size_t i) const {
+		return kind[i] == LexCat::keyword ? findKeyword(text(i)) : Keyword::none;
+	}
+	// recomputed from the text, which only happens for INT64_MAX
+	bool integerOverflow(size_t i) const;
+	void reserve(size_t n);
+	void push(const Lexeme &lex, size_t sourceLength);
+	LexError print(OutputWriter &out = standardOutput, OutputWriter &err = standardError) const;
+}; // TokenBuffer
+
 class LexAnalyzer {
-	int currentLine;
-	int currentColumn;
 	CharCat currentCategory;
 	char currentChar;
 	ScannerState state;
 	bool end_of_file;
-	ifstream file;
+	InputBuffer input;
+	StreamWindow stream;
+	string_view source;
+	size_t sourceBase; // input offset of source[0]; only a stream's moves
+	const char *cursor;
+	const char *limit;
+	size_t lexemeStart; // input offset a refill keeps, or NO_LEXEME
+	bool pastLimit;
+	bool resumeComment;
+	bool badChar;
+	LineIndex lines;
+	deque<string> literalPool;
+	size_t literalsKept; // copies literalPool holds before reusing its oldest, or 0
+	StringTable *strings;
+	LEX_STAT(LexStats stats;)
 
+	void reset(string_view text, size_t from, size_t to, int firstLine, int firstColumn);
 	void getNextChar();
-	CharCat categorizeChar(char c);
+	bool inText() const {
+		return state == ScannerState::incomment || state == ScannerState::commentstar
+			|| state == ScannerState::character;
+	}
+	bool takeUtf8();
+	bool refill(const char *keep);
+	void markBadChar();
+	Lexeme scanNext();
+	void scanLexeme(Lexeme &lex);
+	const char *charPosition() const { return pastLimit ? limit : cursor - 1; }
+	size_t offsetOf(const char *p) const { return sourceBase + (p - source.data()); }
+	const char *pointerAt(size_t offset) const { return source.data() + (offset - sourceBase); }
+	// an error found at currentChar is listed there, or at the character
+	// before when that is end of file
+	size_t errorPosition() const { return offsetOf(charPosition()) - end_of_file; }
+	void skipRun(const char *(*run)(const char *, const char *));
+	template <class Hash> uint64_t hashIdentifier();
+	LEX_STAT(void countRun(const char *from, const char *to);)
+	string_view unescapeLiteral(string_view raw);
+	char peekChar();
+	CharCat categorizeChar(char c) { return CHAR_CATEGORIES[c]; }
 	void handleAlpha(Lexeme &lex);
 	void handleNumber(Lexeme &lex);
 	void handleString(Lexeme &lex);
 	void handleLPar(Lexeme &lex);
+	void skipComment(Lexeme &lex);
 	void handleLSymbol(Lexeme &lex);
 	void handleSymbol(Lexeme &lex);
 public:
+	// no input until open()
+	LexAnalyzer();
+	// an unreadable file lexes as empty input; use open() to find out
 	LexAnalyzer(string filename);
+	// lexes text[from, to) in place; text[from] is at firstLine and
+	// firstColumn. text must outlive the analyzer and every lexeme it returns
+	LexAnalyzer(string_view text, size_t from = 0, size_t to = string_view::npos,
+		int firstLine = 1, int firstColumn = 1);
+	// start over on a new input, keeping buffers and the interning table;
+	// the file version returns false if the file cannot be read
+	bool open(const string &filename);
+	void open(string_view text);
+	// start over on input read from fd as it is lexed, through a window
+	// of about STREAM_WINDOW_SIZE bytes (see StreamWindow). Lexeme
+	// bodies are then only valid until the next lexeme is scanned, and
+	// tokenize(), which keeps the whole input, is not available.
+	void openStream(int fd);
+	// for a range that begins inside a (* *) comment
+	void startInComment() { resumeComment = true; }
+	// enters each identifier into table as it is read, hashing it in the
+	// same pass that finds its end, and sets the lexeme's ref; NULL
+	// stops interning
+	void internInto(StringTable *table) { strings = table; }
+	// keeps only the newest n copies made for character literals with
+	// doubled quotes, reusing the oldest one for the next, which ends
+	// its lexeme's body; 0 keeps them all for the analyzer's lifetime
+	void keepLiterals(size_t n) { literalsKept = n; }
 	Lexeme getNextLexeme();
+	// the remaining lexemes, comments left out, produced as they are
+	// pulled; an error lexeme comes last. A body is only valid until the
+	// next lexeme is pulled, which keeps memory use independent of the
+	// input size. The analyzer must outlive the generator.
+	Generator<Lexeme> lexemes();
+	bool finished() const { return end_of_file || state == ScannerState::error; }
+	// true once the scan has read the end of the input
+	bool endOfFile() const { return end_of_file; }
 
-	// starts the lexAnalyzer
-	void analyze();
+	// lexes the remaining input without printing
+	TokenBuffer tokenize();
+	// lexes one lexeme, appending it to tokens if it is not a comment
+	void tokenizeNext(TokenBuffer &tokens);
+
+	LEX_STAT(const LexStats &getStats() const { return stats; })
+
+	// starts the lexAnalyzer, listing tokens to out and errors to err;
+	// returns the error that stopped it, if any. A LEX_STATS build then
+	// prints its counters to err.
+	LexError analyze(OutputWriter &out = standardOutput, OutputWriter &err = standardError);
 }; // LexAnalyzer
 
-bool issymbol(char c);
+const char *errorString(LexError error);
+
+// value of the digits [p, end); INT64_MAX, with overflow set, if too big
+int64_t parseInteger(const char *p, const char *end, bool &overflow);
+// value of a real literal "digits.digits" in [p, end), correctly rounded
+double parseReal(const char *p, const char *end);
+
+#endif
@@ -0,0 +1,299 @@
+#include "ScanKernels.h"
+#include "Proj1.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//----------------------------------------------------------------------
+// 							scalar kernels
+//----------------------------------------------------------------------
+static inline bool isIdentChar(char c) {
+	CharCat cat = CHAR_CATEGORIES[c];
+	return cat == CharCat::alpha || cat == CharCat::digit;
+}
+
+static inline bool isDigitChar(char c) {
+	return CHAR_CATEGORIES[c] == CharCat::digit;
+}
+
+static inline bool isBlankChar(char c) {
+	return CHAR_CATEGORIES[c] == CharCat::whitespc;
+}
+
+// printable ASCII or whitespace other than CC_EOL, and not Stop
+template <char Stop>
+static inline bool isTextChar(char c) {
+	CharCat cat = CHAR_CATEGORIES[c];
+	return c != Stop && cat != CharCat::eol && cat != CharCat::invalid && cat != CharCat::eof;
+}
+
+//----------------------------------------------------------------------
+// 							  utf8Char
+//----------------------------------------------------------------------
+// Length of the well-formed multibyte character at p, following the
+// Unicode standard's table of well-formed byte sequences: the second
+// byte's range depends on the first, which rules out overlong forms,
+// surrogates and code points past U+10FFFF.
+//----------------------------------------------------------------------
+static inline int utf8Char(const char *p, const char *end) {
+	unsigned char c = *p;
+	unsigned char lo = 0x80, hi = 0xbf; // range of the second byte
+	int n;
+	if (c >= 0xc2 && c <= 0xdf) {
+		n = 2;
+	}
+	else if (c >= 0xe0 && c <= 0xef) {
+		n = 3;
+		if (c == 0xe0) lo = 0xa0;
+		if (c == 0xed) hi = 0x9f;
+	}
+	else if (c >= 0xf0 && c <= 0xf4) {
+		n = 4;
+		if (c == 0xf0) lo = 0x90;
+		if (c == 0xf4) hi = 0x8f;
+	}
+	else {
+		return 0;
+	}
+	if (end - p < n || (unsigned char)p[1] < lo || (unsigned char)p[1] > hi) {
+		return 0;
+	}
+	for (int i = 2; i < n; i++) {
+		if (((unsigned char)p[i] & 0xc0) != 0x80) return 0;
+	}
+	return n;
+}
+
+int utf8Length(const char *p, const char *end) {
+	return p < end ? utf8Char(p, end) : 0;
+}
+
+template <bool (*Accept)(char)>
+static const char *runScalar(const char *p, const char *end) {
+	while (p < end && Accept(*p)) {
+		p++;
+	}
+	return p;
+}
+
+static const char *identRunScalar(const char *p, const char *end) {
+	return runScalar<isIdentChar>(p, end);
+}
+
+static const char *digitRunScalar(const char *p, const char *end) {
+	return runScalar<isDigitChar>(p, end);
+}
+
+static const char *blankRunScalar(const char *p, const char *end) {
+	return runScalar<isBlankChar>(p, end);
+}
+
+template <char Stop>
+static const char *textRunScalar(const char *p, const char *end) {
+	while (p < end) {
+		if (isTextChar<Stop>(*p)) {
+			p++;
+		}
+		else if (int n = utf8Char(p, end)) {
+			p += n;
+		}
+		else {
+			break;
+		}
+	}
+	return p;
+}
+
+static const char *commentRunScalar(const char *p, const char *end) {
+	return textRunScalar<CC_STAR>(p, end);
+}
+
+static const char *literalRunScalar(const char *p, const char *end) {
+	return textRunScalar<CC_QUOTE>(p, end);
+}
+
+static const char *asciiRunScalar(const char *p, const char *end) {
+	while (p < end && (signed char)*p >= 0) {
+		p++;
+	}
+	return p;
+}
+
+static uint32_t *lineBreaksScalar(const char *p, const char *end, uint32_t base, uint32_t *out) {
+	for (const char *q = p; q < end; q++) {
+		if (*q == CC_EOL) {
+			*out++ = base + (q - p);
+		}
+	}
+	return out;
+}
+
+static const ScanKernels SCALAR_KERNELS = {
+	"scalar", identRunScalar, digitRunScalar, blankRunScalar, commentRunScalar, literalRunScalar,
+	asciiRunScalar, lineBreaksScalar
+};
+
+#if defined(__SSE2__)
+//----------------------------------------------------------------------
+// 							SSE2 kernels
+//----------------------------------------------------------------------
+// 16 bytes per step. Every range tested lies in 0..127, so the signed
+// byte compares reject bytes >= 0x80 for free. Most runs in ordinary
+// code end at the very next byte, so that one is checked before any
+// vector work.
+//----------------------------------------------------------------------
+static inline __m128i inRange(__m128i v, char lo, char hi) {
+	return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+		_mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+// \t \v \f \r
+static inline __m128i isCtrlBlank(__m128i v) {
+	return _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(CC_EOL)), inRange(v, '\t', '\r'));
+}
+
+static const char *identRunSse2(const char *p, const char *end) {
+	if (p == end || !isIdentChar(*p)) return p;
+	for (; p + 16 <= end; p += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+		__m128i ok = _mm_or_si128(inRange(lower, 'a', 'z'), inRange(v, '0', '9'));
+		unsigned stop = ~_mm_movemask_epi8(ok) & 0xffff;
+		if (stop) return p + __builtin_ctz(stop);
+	}
+	return identRunScalar(p, end);
+}
+
+static const char *digitRunSse2(const char *p, const char *end) {
+	if (p == end || !isDigitChar(*p)) return p;
+	for (; p + 16 <= end; p += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		unsigned stop = ~_mm_movemask_epi8(inRange(v, '0', '9')) & 0xffff;
+		if (stop) return p + __builtin_ctz(stop);
+	}
+	return digitRunScalar(p, end);
+}
+
+static const char *blankRunSse2(const char *p, const char *end) {
+	if (p == end || !isBlankChar(*p)) return p;
+	for (; p + 16 <= end; p += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i ok = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), isCtrlBlank(v));
+		unsigned stop = ~_mm_movemask_epi8(ok) & 0xffff;
+		if (stop) return p + __builtin_ctz(stop);
+	}
+	return blankRunScalar(p, end);
+}
+
+// A block with no byte >= 0x80 is settled by the ASCII test alone, as
+// is a stop before its first such byte. Past that, SSE2 has no byte
+// shuffle for a table-driven UTF-8 check, so the rest of the block is
+// walked a character at a time.
+template <char Stop>
+static const char *textRunSse2(const char *p, const char *end) {
+	if (p == end || ((signed char)*p >= 0 && !isTextChar<Stop>(*p))) return p;
+	while (p + 16 <= end) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i printable = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(Stop)),
+			inRange(v, CC_MIN, CC_MAX - 1));
+		unsigned high = _mm_movemask_epi8(v);
+		unsigned stop = ~(_mm_movemask_epi8(_mm_or_si128(printable, isCtrlBlank(v))) | high) & 0xffff;
+		unsigned beforeHigh = (high & -high) - 1;
+		if (stop & beforeHigh) return p + __builtin_ctz(stop);
+		if (high == 0) {
+			p += 16;
+			continue;
+		}
+		for (const char *blockEnd = p + 16; p < blockEnd; ) {
+			if (isTextChar<Stop>(*p)) {
+				p++;
+			}
+			else if (int n = utf8Char(p, end)) {
+				p += n;
+			}
+			else {
+				return p;
+			}
+		}
+	}
+	return textRunScalar<Stop>(p, end);
+}
+
+static const char *commentRunSse2(const char *p, const char *end) {
+	return textRunSse2<CC_STAR>(p, end);
+}
+
+static const char *literalRunSse2(const char *p, const char *end) {
+	return textRunSse2<CC_QUOTE>(p, end);
+}
+
+static const char *asciiRunSse2(const char *p, const char *end) {
+	for (; p + 16 <= end; p += 16) {
+		unsigned high = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p));
+		if (high) return p + __builtin_ctz(high);
+	}
+	return asciiRunScalar(p, end);
+}
+
+// one compare per 16 bytes; the set bits of the mask are the line breaks
+static uint32_t *lineBreaksSse2(const char *p, const char *end, uint32_t base, uint32_t *out) {
+	const char *q = p;
+	for (; q + 16 <= end; q += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)q);
+		unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(CC_EOL)));
+		for (; mask != 0; mask &= mask - 1) {
+			*out++ = base + (q - p) + __builtin_ctz(mask);
+		}
+	}
+	return lineBreaksScalar(q, end, base + (q - p), out);
+}
+
+static const ScanKernels SSE2_KERNELS = {
+	"sse2", identRunSse2, digitRunSse2, blankRunSse2, commentRunSse2, literalRunSse2,
+	asciiRunSse2, lineBreaksSse2
+};
+#endif
+
+//----------------------------------------------------------------------
+// 							  bestScanKernels
+//----------------------------------------------------------------------
+static const ScanKernels *bestScanKernels() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (avx2ScanKernels() != NULL && __builtin_cpu_supports("avx2")) {
+		return avx2ScanKernels();
+	}
+#endif
+#if defined(__SSE2__)
+	return &SSE2_KERNELS;
+#else
+	return &SCALAR_KERNELS;
+#endif
+}
+
+const ScanKernels *scanKernels = bestScanKernels();
+
+//----------------------------------------------------------------------
+// 							  useScanKernels
+//----------------------------------------------------------------------
+bool useScanKernels(const char *name) {
+	if (strcmp(name, "scalar") == 0) {
+		scanKernels = &SCALAR_KERNELS;
+		return true;
+	}
+#if defined(__SSE2__)
+	if (strcmp(name, "sse2") == 0) {
+		scanKernels = &SSE2_KERNELS;
+		return true;
+	}
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+	if (strcmp(name, "avx2") == 0 && avx2ScanKernels() != NULL && __builtin_cpu_supports("avx2")) {
+		scanKernels = avx2ScanKernels();
+		return true;
+	}
+#endif
+	return false;
+}
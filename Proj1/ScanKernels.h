@@ -0,0 +1,46 @@
+#ifndef SCANKERNELS_H
+#define SCANKERNELS_H
+
+#include <stdint.h>
+
+// Each run kernel returns the first position in [p, end) whose byte is not
+// part of the run, or end. The scalar set is the reference: the vector
+// sets must stop at exactly the same byte.
+//   identRun   - letters and digits
+//   digitRun   - digits
+//   blankRun   - whitespace other than CC_EOL
+//   commentRun - anything legal inside a comment except CC_STAR, CC_EOL
+//   literalRun - anything legal inside a literal except CC_QUOTE, CC_EOL
+//   asciiRun   - bytes below 0x80
+// Legal text is printable ASCII, whitespace, and well-formed UTF-8
+// characters; a text run stops at the first byte of a malformed one, or
+// of one that end cuts short.
+// lineBreaks writes base + (q - p) for each CC_EOL q in [p, end) to out,
+// in order, and returns the end of what it wrote.
+struct ScanKernels {
+	const char *name;
+	const char *(*identRun)(const char *p, const char *end);
+	const char *(*digitRun)(const char *p, const char *end);
+	const char *(*blankRun)(const char *p, const char *end);
+	const char *(*commentRun)(const char *p, const char *end);
+	const char *(*literalRun)(const char *p, const char *end);
+	const char *(*asciiRun)(const char *p, const char *end);
+	uint32_t *(*lineBreaks)(const char *p, const char *end, uint32_t base, uint32_t *out);
+};
+
+// length of the well-formed UTF-8 character of two or more bytes that
+// starts at p, or 0 if there is none in [p, end)
+int utf8Length(const char *p, const char *end);
+
+// selected once at startup from the CPU's feature flags
+extern const ScanKernels *scanKernels;
+
+// switches to the named set ("scalar", "sse2", "avx2"); returns false
+// if this build or CPU cannot run it.
+bool useScanKernels(const char *name);
+
+// defined in ScanKernelsAvx2.cpp, the only file built with -mavx2; NULL
+// when the compiler could not target AVX2
+const ScanKernels *avx2ScanKernels();
+
+#endif
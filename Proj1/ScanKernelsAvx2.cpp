@@ -0,0 +1,296 @@
+// Built with -mavx2. Only intrinsics and plain C are used here so that
+// no inline function from a shared header is emitted with AVX2 code.
+#include "ScanKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#include <string.h>
+
+//----------------------------------------------------------------------
+// 							AVX2 kernels
+//----------------------------------------------------------------------
+// 32 bytes per step; mirror the SSE2 kernels in ScanKernels.cpp,
+// including the early exit when the first byte already ends the run.
+// A run's tail is copied into a zero-padded block, and a zero byte ends
+// every run, so no scalar loop is needed (the text runs below are the
+// exception).
+//----------------------------------------------------------------------
+static inline __m256i inRange(__m256i v, char lo, char hi) {
+	return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+static inline __m256i isCtrlBlank(__m256i v) {
+	return _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), inRange(v, '\t', '\r'));
+}
+
+static inline __m256i isIdent(__m256i v) {
+	__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+	return _mm256_or_si256(inRange(lower, 'a', 'z'), inRange(v, '0', '9'));
+}
+
+static inline __m256i isDigit(__m256i v) {
+	return inRange(v, '0', '9');
+}
+
+static inline __m256i isBlank(__m256i v) {
+	return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), isCtrlBlank(v));
+}
+
+template <char Stop>
+static inline __m256i isText(__m256i v) {
+	__m256i printable = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(Stop)),
+		inRange(v, ' ', '~' - 1));
+	return _mm256_or_si256(printable, isCtrlBlank(v));
+}
+
+static inline bool isIdentChar(char c) {
+	return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || (c >= '0' && c <= '9');
+}
+
+static inline bool isDigitChar(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static inline bool isBlankChar(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r' && c != '\n');
+}
+
+template <char Stop>
+static inline bool isTextChar(char c) {
+	return (c >= ' ' && c < '~' && c != Stop) || (c >= '\t' && c <= '\r' && c != '\n');
+}
+
+template <__m256i (*Accept)(__m256i), bool (*AcceptFirst)(char)>
+static const char *runAvx2(const char *p, const char *end) {
+	if (p == end || !AcceptFirst(*p)) return p;
+	for (; p + 32 <= end; p += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)p);
+		unsigned stop = ~(unsigned)_mm256_movemask_epi8(Accept(v));
+		if (stop) return p + __builtin_ctz(stop);
+	}
+	if (p == end) return end;
+	char tail[32] = {0};
+	memcpy(tail, p, end - p);
+	unsigned stop = ~(unsigned)_mm256_movemask_epi8(Accept(_mm256_loadu_si256((const __m256i *)tail)));
+	return p + __builtin_ctz(stop); // stops at or before the first padding byte
+}
+
+//----------------------------------------------------------------------
+// 							UTF-8 text runs
+//----------------------------------------------------------------------
+// Comment and literal text is checked 32 bytes at a time with Keiser
+// and Lemire's lookup validator ("Validating UTF-8 In Less Than One
+// Instruction Per Byte", 2021): three 16-entry tables, indexed by the
+// nibbles of each byte and of the byte before it, each give the set of
+// errors that pair could be part of, and a pair is malformed where all
+// three agree. Third and fourth bytes are checked separately against
+// the leads two and three bytes back. The validator only runs on blocks
+// with a byte >= 0x80 or just after one that might end mid-character,
+// so ASCII text costs the same as before. It tells that a block is bad,
+// not where, so a bad block is rescanned one character at a time from
+// the start of the character it begins in.
+//----------------------------------------------------------------------
+static inline int utf8Char(const char *p, const char *end) {
+	unsigned char c = *p;
+	unsigned char lo = 0x80, hi = 0xbf;
+	int n;
+	if (c >= 0xc2 && c <= 0xdf) {
+		n = 2;
+	}
+	else if (c >= 0xe0 && c <= 0xef) {
+		n = 3;
+		if (c == 0xe0) lo = 0xa0;
+		if (c == 0xed) hi = 0x9f;
+	}
+	else if (c >= 0xf0 && c <= 0xf4) {
+		n = 4;
+		if (c == 0xf0) lo = 0x90;
+		if (c == 0xf4) hi = 0x8f;
+	}
+	else {
+		return 0;
+	}
+	if (end - p < n || (unsigned char)p[1] < lo || (unsigned char)p[1] > hi) {
+		return 0;
+	}
+	for (int i = 2; i < n; i++) {
+		if (((unsigned char)p[i] & 0xc0) != 0x80) return 0;
+	}
+	return n;
+}
+
+template <char Stop>
+static const char *textRunTail(const char *p, const char *end) {
+	while (p < end) {
+		if (isTextChar<Stop>(*p)) {
+			p++;
+		}
+		else if (int n = utf8Char(p, end)) {
+			p += n;
+		}
+		else {
+			break;
+		}
+	}
+	return p;
+}
+
+// the lead byte of a character that runs into p, if one does; text
+// from start to there is known to be well-formed
+static inline const char *characterStart(const char *start, const char *p) {
+	for (int k = 1; k <= 3 && p - k >= start; k++) {
+		unsigned char c = p[-k];
+		if (c < 0x80) break;
+		if (c >= 0xc0) return p - k;
+	}
+	return p;
+}
+
+static inline __m256i lookup16(__m256i index, const unsigned char table[16]) {
+	__m128i t = _mm_loadu_si128((const __m128i *)table);
+	return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(t), index);
+}
+
+static inline __m256i highNibbles(__m256i v) {
+	return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+}
+
+// input shifted N bytes later, with the end of prev shifted in
+template <int N>
+static inline __m256i previous(__m256i input, __m256i prev) {
+	return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+}
+
+const unsigned char TOO_SHORT = 1 << 0; // a lead or ASCII byte where a continuation belongs
+const unsigned char TOO_LONG = 1 << 1; // a continuation after ASCII
+const unsigned char OVERLONG_3 = 1 << 2;
+const unsigned char TOO_LARGE = 1 << 3; // past U+10FFFF
+const unsigned char SURROGATE = 1 << 4;
+const unsigned char OVERLONG_2 = 1 << 5;
+const unsigned char TOO_LARGE_1000 = 1 << 6;
+const unsigned char OVERLONG_4 = 1 << 6;
+const unsigned char TWO_CONTS = 1 << 7; // a second continuation, which must be a 3rd or 4th byte
+const unsigned char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+static const unsigned char BYTE_1_HIGH[16] = {
+	TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+	TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+	TOO_SHORT | OVERLONG_2,
+	TOO_SHORT,
+	TOO_SHORT | OVERLONG_3 | SURROGATE,
+	TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+static const unsigned char BYTE_1_LOW[16] = {
+	CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+	CARRY | OVERLONG_2,
+	CARRY,
+	CARRY,
+	CARRY | TOO_LARGE,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+static const unsigned char BYTE_2_HIGH[16] = {
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+// nonzero where input, following prev, is not well-formed
+static inline __m256i utf8Errors(__m256i input, __m256i prev) {
+	__m256i prev1 = previous<1>(input, prev);
+	__m256i special = _mm256_and_si256(
+		_mm256_and_si256(lookup16(highNibbles(prev1), BYTE_1_HIGH),
+			lookup16(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)), BYTE_1_LOW)),
+		lookup16(highNibbles(input), BYTE_2_HIGH));
+	__m256i third = _mm256_subs_epu8(previous<2>(input, prev), _mm256_set1_epi8(0xe0 - 0x80));
+	__m256i fourth = _mm256_subs_epu8(previous<3>(input, prev), _mm256_set1_epi8(0xf0 - 0x80));
+	__m256i mustContinue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(0x80));
+	return _mm256_xor_si256(mustContinue, special);
+}
+
+template <char Stop>
+static const char *textRunAvx2(const char *p, const char *end) {
+	if (p == end || ((signed char)*p >= 0 && !isTextChar<Stop>(*p))) return p;
+	const char *start = p;
+	__m256i prev = _mm256_setzero_si256();
+	bool pending = false; // prev may end part way through a character
+	for (; p + 32 <= end; p += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)p);
+		unsigned high = _mm256_movemask_epi8(v);
+		if (high != 0 || pending) {
+			__m256i errors = utf8Errors(v, prev);
+			if (!_mm256_testz_si256(errors, errors)) {
+				return textRunTail<Stop>(characterStart(start, p), end);
+			}
+			pending = (high >> 29) != 0;
+		}
+		unsigned stop = ~((unsigned)_mm256_movemask_epi8(isText<Stop>(v)) | high);
+		if (stop) return p + __builtin_ctz(stop);
+		prev = v;
+	}
+	if (p < end && !pending) {
+		char tail[32] = {0};
+		memcpy(tail, p, end - p);
+		__m256i v = _mm256_loadu_si256((const __m256i *)tail);
+		if (_mm256_movemask_epi8(v) == 0) {
+			unsigned stop = ~(unsigned)_mm256_movemask_epi8(isText<Stop>(v));
+			return p + __builtin_ctz(stop); // at or before the first padding byte
+		}
+	}
+	return textRunTail<Stop>(characterStart(start, p), end);
+}
+
+static const char *asciiRunAvx2(const char *p, const char *end) {
+	for (; p + 32 <= end; p += 32) {
+		unsigned high = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)p));
+		if (high) return p + __builtin_ctz(high);
+	}
+	while (p < end && (signed char)*p >= 0) {
+		p++;
+	}
+	return p;
+}
+
+static uint32_t *lineBreaksAvx2(const char *p, const char *end, uint32_t base, uint32_t *out) {
+	const char *q = p;
+	for (; q + 32 <= end; q += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)q);
+		unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+		for (; mask != 0; mask &= mask - 1) {
+			*out++ = base + (q - p) + __builtin_ctz(mask);
+		}
+	}
+	for (; q < end; q++) {
+		if (*q == '\n') {
+			*out++ = base + (q - p);
+		}
+	}
+	return out;
+}
+
+static const ScanKernels AVX2_KERNELS = {
+	"avx2", runAvx2<isIdent, isIdentChar>, runAvx2<isDigit, isDigitChar>,
+	runAvx2<isBlank, isBlankChar>, textRunAvx2<'*'>, textRunAvx2<'\''>, asciiRunAvx2, lineBreaksAvx2
+};
+
+const ScanKernels *avx2ScanKernels() {
+	return &AVX2_KERNELS;
+}
+#else
+const ScanKernels *avx2ScanKernels() {
+	return NULL;
+}
+#endif
@@ -0,0 +1,107 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+const size_t CACHE_LINE_SIZE = 64;
+
+//----------------------------------------------------------------------
+// A bounded queue between exactly one producer thread and one consumer
+// thread, with no locks. The producer owns tail and the consumer owns
+// head; each keeps a private copy of the other's index and only reloads
+// it when the ring looks full (or empty), so in steady state the two
+// cache lines are written once per batch and read about as often.
+// push() blocks while the ring is full, which holds the producer back
+// to the consumer's pace, and pop() blocks while it is empty; both
+// sleep in atomic wait rather than spin. close() marks the end of the
+// stream in tail's top bit, so a waiting consumer wakes for it.
+//----------------------------------------------------------------------
+template <class T>
+class SpscRing {
+	static const size_t CLOSED = (size_t)1 << (sizeof(size_t) * 8 - 1);
+
+	vector<T> slots;
+	size_t mask;
+	alignas(CACHE_LINE_SIZE) atomic<size_t> head; // next slot to read
+	size_t cachedTail; // consumer's copy
+	alignas(CACHE_LINE_SIZE) atomic<size_t> tail; // next slot to write, | CLOSED at the end
+	size_t cachedHead; // producer's copy
+
+public:
+	// capacity is rounded up to a power of two
+	explicit SpscRing(size_t capacity) : head(0), cachedTail(0), tail(0), cachedHead(0) {
+		size_t size = 1;
+		while (size < capacity) {
+			size *= 2;
+		}
+		slots.resize(size);
+		mask = size - 1;
+	}
+	SpscRing(const SpscRing &) = delete;
+	SpscRing &operator=(const SpscRing &) = delete;
+
+	size_t capacity() const { return slots.size(); }
+
+	// producer: copies in all n items, publishing them as one batch per
+	// stretch of free slots and waiting whenever there are none
+	void push(const T *items, size_t n) {
+		size_t t = tail.load(memory_order_relaxed);
+		while (n > 0) {
+			size_t room = slots.size() - (t - cachedHead);
+			if (room == 0) {
+				cachedHead = head.load(memory_order_acquire);
+				room = slots.size() - (t - cachedHead);
+				if (room == 0) {
+					head.wait(cachedHead, memory_order_acquire);
+					continue;
+				}
+			}
+			size_t k = min(n, room);
+			for (size_t i = 0; i < k; i++) {
+				slots[(t + i) & mask] = items[i];
+			}
+			items += k;
+			n -= k;
+			t += k;
+			tail.store(t, memory_order_release);
+			tail.notify_one();
+		}
+	}
+
+	// producer: nothing more will be pushed
+	void close() {
+		tail.store(tail.load(memory_order_relaxed) | CLOSED, memory_order_release);
+		tail.notify_one();
+	}
+
+	// consumer: waits for at least one item and moves out up to max of
+	// them; returns 0 only once the ring is closed and drained
+	size_t pop(T *out, size_t max) {
+		size_t h = head.load(memory_order_relaxed);
+		size_t available = cachedTail - h;
+		while (available == 0) {
+			size_t t = tail.load(memory_order_acquire);
+			cachedTail = t & ~CLOSED;
+			available = cachedTail - h;
+			if (available == 0) {
+				if (t & CLOSED) {
+					return 0;
+				}
+				tail.wait(t, memory_order_acquire);
+			}
+		}
+		size_t k = min(max, available);
+		for (size_t i = 0; i < k; i++) {
+			out[i] = slots[(h + i) & mask];
+		}
+		head.store(h + k, memory_order_release);
+		head.notify_one();
+		return k;
+	}
+}; // SpscRing
+
+#endif
@@ -0,0 +1,93 @@
+#include "Proj1.h"
+#include "Parallel.h"
+#include "Batch.h"
+#include "Dfa.h"
+#include "Pipeline.h"
+
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+//----------------------------------------------------------------------
+// 									main
+//----------------------------------------------------------------------
+// usage: scan [-j threads | -d | -p] [filename | -]
+//        scan -b [-j threads] directory|@listfile|filename...
+// -d lexes with the table-driven engine in Dfa.h; -p scans and prints
+// on two threads (Pipeline.h). Standard input, named as - or piped in
+// with no filename, is lexed as it arrives through a StreamWindow; the
+// other modes read it whole first. A filename is asked for only when
+// standard input is a terminal.
+//----------------------------------------------------------------------
+int main(int argc, char **argv) {
+	string filename = "";
+	int threads = 0;
+	bool batch = false;
+	bool dfa = false;
+	bool pipelined = false;
+	vector<string> inputs;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-b") == 0) {
+			batch = true;
+		}
+		else if (strcmp(argv[i], "-d") == 0) {
+			dfa = true;
+		}
+		else if (strcmp(argv[i], "-p") == 0) {
+			pipelined = true;
+		}
+		else {
+			filename = argv[i];
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (batch) {
+		if (threads <= 0) {
+			threads = max(1u, thread::hardware_concurrency());
+		}
+		return lexFiles(expandInputs(inputs), threads) > 0 ? 1 : 0;
+	}
+	if (filename.empty() && !isatty(STDIN_FILENO)) {
+		filename = "-";
+	}
+	if (filename.empty()) {
+		cout << "Enter a filename: ";
+		cin >> filename;
+	}
+	bool standardInput = filename == "-";
+	LexError error;
+	if (threads > 0 || dfa || (pipelined && standardInput)) {
+		InputBuffer input;
+		if (!(standardInput ? input.openFd(STDIN_FILENO) : input.open(filename))) {
+			cerr << "File read error\n";
+			return 1;
+		}
+		string_view source(input.begin(), input.size());
+		if (threads > 0 || dfa) {
+			TokenBuffer tokens = dfa ? tokenizeDfa(source) : tokenizeParallel(source, threads);
+			error = tokens.print();
+		}
+		else { // -p's lexemes would outlive a stream's window
+			LexAnalyzer lex(source);
+			error = analyzePipelined(lex);
+		}
+	}
+	else if (standardInput) {
+		LexAnalyzer lex;
+		lex.openStream(STDIN_FILENO);
+		error = lex.analyze();
+	}
+	else {
+		LexAnalyzer lex;
+		if (!lex.open(filename)) {
+			cerr << "File read error\n";
+			return 1;
+		}
+		error = pipelined ? analyzePipelined(lex) : lex.analyze();
+	}
+	// an unrecognized character has always ended the scan with status 1
+	return error == LexError::unrecognizedChar ? 1 : 0;
+}
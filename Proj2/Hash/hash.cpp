@@ -1,67 +1,257 @@
-#include <iostream>
-#include <vector>
+//---------------------------------------------------------------------
+// Evaluates the StringTable hash policies on Proj2's test files, on
+// pgm.pas's words and on generated sets that are hard on weak hashes.
+// For each hash and set of distinct items it reports:
+//   chi2/df - chi-square of the items spread over the next power of two
+//             >= items buckets, indexed like the table's groups by the
+//             hash bits from STRTBL_GROUP_SHIFT up, per degree of
+//             freedom; about 1 for a uniform hash
+//   chain   - the most items in one of those buckets
+//   probes  - the mean groups a BasicStringTable search reads for them
+//   worst, mean avalanche bias - over flipping each bit of an item's
+//             first AVALANCHE_BYTES bytes, how far each output bit's
+//             chance of flipping is from 1/2 (0 ideal, 1 never or always),
+//             over input bits at least AVALANCHE_MIN_KEYS items have. A
+//             perfect hash still shows a mean of about sqrt(2 / (pi *
+//             items sampled)) from sampling alone, 0.018 for 2000
+//   GB/s    - item bytes hashed per second
+// usage: hash [file ...], each file read one item per line as Proj2's
+// driver reads it; with no files, the sets described above
+//---------------------------------------------------------------------
+#include "../proj2.h"
 
-const int NUM_BUCKETS = 1000;
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_set>
 
-int hash(std::string str) {
-	int seed = 0;
-	// makes hash likely to be different for strings with differing chars,
-	// and guaranteed to be different for strings with 1 char.
-	for (size_t i = 0; i < str.length(); i++) {
-		seed += str[i];
-		seed *= str[i]; // helps spread distribution
+const size_t AVALANCHE_KEYS = 2000;
+const size_t AVALANCHE_BYTES = 64;
+const int AVALANCHE_MIN_KEYS = 32;
+const double THROUGHPUT_SECONDS = 0.2;
+
+struct Corpus {
+	string name;
+	vector<string> items;
+	size_t duplicates;
+};
+
+// keeps the first of each item, counting the rest
+Corpus makeCorpus(const string &name, const vector<string> &all) {
+	Corpus corpus = {name, {}, 0};
+	unordered_set<string> seen;
+	for (const string &item : all) {
+		if (seen.insert(item).second) {
+			corpus.items.push_back(item);
+		} else {
+			corpus.duplicates++;
+		}
 	}
-	// allows strings that are permutations of one another to be different.
-	// ex. abc, cba, bac
-	for (size_t i = 0; i < str.length(); i++) {
-		seed += (i+1) ^ str[i];
+	return corpus;
+}
+
+vector<string> readLines(const string &path) {
+	vector<string> items;
+	ifstream f(path.c_str());
+	string line;
+	while (!f.eof() && !f.fail()) {
+		getline(f, line);
+		items.push_back(line);
 	}
-	if (seed < 0) {
-		seed = seed + 1000;
+	return items;
+}
+
+// a program's identifiers and numbers, the way Proj1 would intern them
+vector<string> readWords(const string &path) {
+	vector<string> words;
+	ifstream f(path.c_str());
+	string word;
+	char c;
+	while (f.get(c)) {
+		if (isalnum((unsigned char)c) || c == '_') {
+			word += c;
+		} else if (!word.empty()) {
+			words.push_back(word);
+			word.clear();
+		}
+	}
+	if (!word.empty()) {
+		words.push_back(word);
 	}
-	return seed % 1000;
+	return words;
 }
 
-int main() {
-	std::string input = "";
-	int list[1000] = {0};
-	int entries = 0;
-	while (!std::cin.eof()) {
-		std::cin >> input;
-		inputs.push_back(input);
-		entries += 1;
-		int hsh = hash(input);
-		list[hsh] += 1;
-		//std::cout << hsh << std::endl;
-	}
-	float collisions = 0;
-	int sumOfIndices = 0;
-	int sumOfIndicesWeighted = 0;
-	int max = 0;
-	int maxEntries = 0;
-	for (size_t i = 0; i < NUM_BUCKETS; i++) {
-		if (list[i] > 1) {
-			collisions += 1;
+vector<Corpus> generatedCorpora() {
+	vector<Corpus> corpora;
+	vector<string> items;
+	for (int i = 0; i < 200000; i++) {
+		items.push_back(to_string(i));
+	}
+	corpora.push_back(makeCorpus("numbers 0-199999", items));
+
+	items.clear();
+	string letters = "abcdefgh";
+	do {
+		items.push_back(letters);
+	} while (next_permutation(letters.begin(), letters.end()));
+	corpora.push_back(makeCorpus("permutations of abcdefgh", items));
+
+	items.clear();
+	for (int i = 0; i < 100000; i++) {
+		items.push_back("a_very_long_common_identifier_prefix_" + to_string(i));
+	}
+	corpora.push_back(makeCorpus("long common prefix", items));
+
+	items.clear();
+	for (char a = ' '; a <= '~'; a++) {
+		for (char b = ' '; b <= '~'; b++) {
+			items.push_back(string(1, a) + b);
 		}
-		if (list[i] > 0) {
-			sumOfIndices += i;
-			sumOfIndicesWeighted += (i * list[i]);
+	}
+	corpora.push_back(makeCorpus("two printable chars", items));
+	return corpora;
+}
+
+struct Quality {
+	double chiSquare;
+	int longestChain;
+	double probes;
+	double worstBias;
+	double meanBias;
+	double gbPerSec;
+};
+
+template <class Hash>
+void measureSpread(const vector<string> &items, Quality &q) {
+	size_t buckets = 1;
+	while (buckets < items.size()) {
+		buckets *= 2;
+	}
+	vector<int> counts(buckets, 0);
+	for (const string &item : items) {
+		counts[(Hash::hash(item) >> STRTBL_GROUP_SHIFT) & (buckets - 1)]++;
+	}
+	double expected = (double)items.size() / buckets;
+	double sum = 0;
+	q.longestChain = 0;
+	for (int count : counts) {
+		sum += (count - expected) * (count - expected) / expected;
+		q.longestChain = max(q.longestChain, count);
+	}
+	q.chiSquare = buckets > 1 ? sum / (buckets - 1) : 0;
+
+	BasicStringTable<Hash> table;
+	for (const string &item : items) {
+		table.insert(item);
+	}
+	q.probes = table.probeLength();
+}
+
+template <class Hash>
+void measureAvalanche(const vector<string> &items, Quality &q) {
+	const size_t inputBits = AVALANCHE_BYTES * 8;
+	// flips[i][j]: times flipping input bit i flipped output bit j
+	vector<vector<int>> flips(inputBits, vector<int>(64, 0));
+	vector<int> trials(inputBits, 0);
+	size_t stride = max((size_t)1, items.size() / AVALANCHE_KEYS);
+	for (size_t k = 0; k < items.size(); k += stride) {
+		string key = items[k];
+		uint64_t h = Hash::hash(key);
+		size_t bits = min(key.size(), AVALANCHE_BYTES) * 8;
+		for (size_t i = 0; i < bits; i++) {
+			key[i / 8] ^= 1 << (i % 8);
+			uint64_t diff = h ^ Hash::hash(key);
+			key[i / 8] ^= 1 << (i % 8);
+			trials[i]++;
+			for (int j = 0; j < 64; j++) {
+				flips[i][j] += diff >> j & 1;
+			}
+		}
+	}
+	q.worstBias = 0;
+	double sum = 0;
+	size_t cells = 0;
+	for (size_t i = 0; i < inputBits; i++) {
+		if (trials[i] < AVALANCHE_MIN_KEYS) {
+			continue;
+		}
+		for (int j = 0; j < 64; j++) {
+			double bias = fabs(2.0 * flips[i][j] / trials[i] - 1);
+			q.worstBias = max(q.worstBias, bias);
+			sum += bias;
+			cells++;
+		}
+	}
+	q.meanBias = cells > 0 ? sum / cells : 0;
+}
+
+template <class Hash>
+void measureThroughput(const vector<string> &items, Quality &q) {
+	size_t bytes = 0;
+	volatile uint64_t sink = 0;
+	auto start = chrono::steady_clock::now();
+	double seconds = 0;
+	do {
+		uint64_t x = 0;
+		for (const string &item : items) {
+			x += Hash::hash(item);
+			bytes += item.size();
+		}
+		sink = x;
+		seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	} while (seconds < THROUGHPUT_SECONDS);
+	(void)sink; // written only so the hashing is not optimized away
+	q.gbPerSec = bytes / seconds / 1e9;
+}
+
+template <class Hash>
+void report(const char *name, const vector<string> &items) {
+	Quality q;
+	measureSpread<Hash>(items, q);
+	measureAvalanche<Hash>(items, q);
+	measureThroughput<Hash>(items, q);
+	cout << setw(10) << name << setw(9) << q.chiSquare << setw(7) << q.longestChain
+		<< setw(8) << q.probes << setw(8) << q.worstBias << setw(8) << q.meanBias
+		<< setw(8) << q.gbPerSec << endl;
+}
+
+int main(int argc, char **argv) {
+	vector<Corpus> corpora;
+	for (int i = 1; i < argc; i++) {
+		corpora.push_back(makeCorpus(argv[i], readLines(argv[i])));
+	}
+	if (corpora.empty()) {
+		for (const char *path : {"../test.txt", "../test2.txt", "../file.txt"}) {
+			corpora.push_back(makeCorpus(path, readLines(path)));
 		}
-		if (list[i] > max) {
-			max = i;
-			maxEntries = list[i];
+		corpora.push_back(makeCorpus("pgm.pas words", readWords("pgm.pas")));
+		for (const Corpus &corpus : generatedCorpora()) {
+			corpora.push_back(corpus);
 		}
 	}
 
-	std::cout << "-------------------------------------------" << std::endl;
-	std::cout << "Collisions: " << (collisions/entries)*100 << " percent" << std::endl;
-	std::cout << "Number of collisions: " << collisions << std::endl;
-	std::cout << "Number of Entries: " << entries << std::endl;
-	std::cout << "Entry location mean (unweighted): " << (float)sumOfIndices/(float)entries << std::endl;
-	std::cout << "Entry location mean (weighted): " << (float)sumOfIndicesWeighted/(float)entries << std::endl;
-	std::cout << "Maximally filled bucket: " << max << std::endl;
-	std::cout << "With: " << maxEntries << " Entries" << std::endl;
-	std::cout << "Number of matching strings: " << sameString << std::endl;
-	std::cout << "-------------------------------------------" << std::endl;
+	cout << "buckets and groups from hash bits " << STRTBL_GROUP_SHIFT << " and up" << endl;
+	cout << fixed << setprecision(3);
+	for (const Corpus &corpus : corpora) {
+		size_t bytes = 0;
+		for (const string &item : corpus.items) {
+			bytes += item.size();
+		}
+		cout << "-------------------------------------------" << endl;
+		cout << corpus.name << ": " << corpus.items.size() << " distinct items ("
+			<< corpus.duplicates << " duplicates), "
+			<< (corpus.items.empty() ? 0 : (double)bytes / corpus.items.size()) << " bytes on average"
+			<< endl;
+		if (corpus.items.empty()) {
+			continue;
+		}
+		cout << setw(10) << "hash" << setw(9) << "chi2/df" << setw(7) << "chain"
+			<< setw(8) << "probes" << setw(8) << "worst" << setw(8) << "mean"
+			<< setw(8) << "GB/s" << endl;
+		report<LegacyHash>("legacy", corpus.items);
+		report<MurmurHash>("murmur3", corpus.items);
+		report<WideHash>("wide", corpus.items);
+	}
+	cout << "-------------------------------------------" << endl;
 	return 0;
 }
@@ -6,44 +6,389 @@
 //---------------------------------------------------------------------
 
 #include "proj2.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Hash/MurmurHash3.h"
+
+const signed char EMPTY = -128; // a control byte no tag can equal
+
+static inline signed char tagOf(uint64_t hashVal) {
+    return hashVal >> 57;
+}
+
+static inline size_t firstGroup(uint64_t hashVal, size_t groupMask) {
+    return (hashVal >> STRTBL_GROUP_SHIFT) & groupMask;
+}
+
+// as much of an entry's hash as the table uses; tagOf() and firstGroup()
+// only read the top 32 bits.
+static inline uint64_t hashOf(StringTableRef entry) {
+    return (uint64_t)entry->hashHigh << 32;
+}
+
+// bit i set if group[i] == c
+static inline unsigned matchGroup(const signed char *group, signed char c) {
+#if defined(__SSE2__)
+    __m128i v = _mm_loadu_si128((const __m128i *)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+#else
+    unsigned mask = 0;
+    for (size_t i = 0; i < STRTBL_GROUP_WIDTH; i++) {
+        mask |= (unsigned)(group[i] == c) << i;
+    }
+    return mask;
+#endif
+}
+//---------------------------------------------------------------------
+//                      LegacyHash::hash()
+//---------------------------------------------------------------------
+// StringHash's 32 bits, spread over all 64 by a multiply.
+uint64_t LegacyHash::hash(string_view item) {
+    StringHash h;
+    for (size_t i = 0; i < item.length(); i++) {
+        h.add(item[i]);
+    }
+    return (uint64_t)h.value() * 0x9e3779b97f4a7c15ull;
+}
+//---------------------------------------------------------------------
+//                      MurmurHash::hash()
+//---------------------------------------------------------------------
+uint64_t MurmurHash::hash(string_view item) {
+    uint64_t out[2];
+    MurmurHash3_x64_128(item.data(), item.length(), RANDOMSEED, out);
+    return out[0];
+}
+//---------------------------------------------------------------------
+//                      WideHash::hash()
+//---------------------------------------------------------------------
+// In the manner of wyhash: each whole 8 bytes is folded in by a
+// 64x64->128-bit multiply whose two halves are xored together, then
+// the 0 to 7 bytes left over and the length. The leftover bytes are
+// read without a loop or a variable-length copy: from the last whole
+// word, shifted, when there is one, otherwise as two 4-byte halves
+// that may overlap or as 3 sampled bytes, which cover a text of 3.
+static inline uint64_t load64(const char *p) {
+    uint64_t word;
+    memcpy(&word, p, 8);
+    return word;
+}
+
+static inline uint64_t load32(const char *p) {
+    uint32_t word;
+    memcpy(&word, p, 4);
+    return word;
+}
+
+uint64_t WideHash::hash(string_view item) {
+    const char *p = item.data();
+    size_t n = item.length();
+    const char *whole = p + (n & ~(size_t)7); // end of the whole words
+    size_t left = n & 7;
+    uint64_t h = start();
+    for (; p < whole; p += 8) {
+        h = step(h, load64(p));
+    }
+    uint64_t tail;
+    if (left == 0) {
+        tail = 0;
+    }
+    else if (n >= 8) {
+        tail = load64(p + left - 8) >> (64 - 8 * left);
+    }
+    else if (left >= 4) {
+        tail = load32(p) | load32(p + left - 4) << (8 * (left - 4));
+    }
+    else {
+        tail = (uint64_t)(unsigned char)p[0] | (uint64_t)(unsigned char)p[left / 2] << (8 * (left / 2))
+            | (uint64_t)(unsigned char)p[left - 1] << (8 * (left - 1));
+    }
+    return finish(h, tail, n);
+}
 //---------------------------------------------------------------------
-//                      StringTable::StringTable
+//                      BasicStringTable::BasicStringTable
 //---------------------------------------------------------------------
-StringTable::StringTable() {
+template <class Hash>
+BasicStringTable<Hash>::BasicStringTable() {
+    allocate(STRTBL_MIN_SLOTS);
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::~BasicStringTable()
+//---------------------------------------------------------------------
+template <class Hash>
+BasicStringTable<Hash>::~BasicStringTable() {
+    destruct();
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::insert()
+//---------------------------------------------------------------------
+// item is copied only if it is new.
+template <class Hash>
+StringTableRef BasicStringTable<Hash>::insert(string_view item) {
+    return insert(item, Hash::hash(item));
+}
+
+template <class Hash>
+StringTableRef BasicStringTable<Hash>::insert(string_view item, uint64_t hashVal) {
+    StringTableRef found = find(item, hashVal);
+    if (found != NULL) {
+        return found;
+    }
+    if (numEntries >= growAt) {
+        grow();
+    }
+    void *p = arena.allocate(sizeof(StringTableEntry) + item.length(), alignof(StringTableEntry));
+    StringTableEntry *entry = new (p) StringTableEntry{(uint32_t)item.length(), (uint32_t)(hashVal >> 32)};
+    memcpy(entry + 1, item.data(), item.length());
+    if (place(hashVal, entry) > 0) {
+        numCollisions += 1;
+    }
+    numEntries += 1;
+    return entry;
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::search()
+//---------------------------------------------------------------------
+// returns pointer to a StringTableEntry if found, otherwise returns NULL.
+template <class Hash>
+StringTableRef BasicStringTable<Hash>::search(string_view searchName) {
+    return find(searchName, Hash::hash(searchName));
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::find()
+//---------------------------------------------------------------------
+// probes from item's first group until a group with an EMPTY slot, which
+// item would have been placed in or before. A slot whose tag matches is
+// checked against its entry's stored hash before any bytes are compared.
+template <class Hash>
+StringTableRef BasicStringTable<Hash>::find(string_view item, uint64_t hashVal) {
+    signed char tag = tagOf(hashVal);
+    size_t group = firstGroup(hashVal, groupMask);
+    for (size_t step = 1; ; step++) {
+        size_t first = group * STRTBL_GROUP_WIDTH;
+        for (unsigned m = matchGroup(&control[first], tag); m != 0; m &= m - 1) {
+            StringTableRef entry = slots[first + __builtin_ctz(m)];
+            if (entry->hashHigh == hashVal >> 32 && entry->data() == item) {
+                return entry;
+            }
+        }
+        if (matchGroup(&control[first], EMPTY) != 0) {
+            return NULL;
+        }
+        group = (group + step) & groupMask;
+    }
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::place()
+//---------------------------------------------------------------------
+// puts entry in the first EMPTY slot on its probe sequence; returns the
+// number of full groups passed on the way.
+template <class Hash>
+size_t BasicStringTable<Hash>::place(uint64_t hashVal, StringTableRef entry) {
+    size_t group = firstGroup(hashVal, groupMask);
+    for (size_t step = 1; ; step++) {
+        size_t first = group * STRTBL_GROUP_WIDTH;
+        unsigned empty = matchGroup(&control[first], EMPTY);
+        if (empty != 0) {
+            size_t i = first + __builtin_ctz(empty);
+            control[i] = tagOf(hashVal);
+            slots[i] = entry;
+            return step - 1;
+        }
+        group = (group + step) & groupMask;
+    }
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::probeLength()
+//---------------------------------------------------------------------
+// the mean number of groups a search for an entry in the table reads.
+template <class Hash>
+double BasicStringTable<Hash>::probeLength() const {
+    size_t total = 0;
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (control[i] == EMPTY) {
+            continue;
+        }
+        size_t group = firstGroup(hashOf(slots[i]), groupMask);
+        size_t probes = 1;
+        for (size_t step = 1; group != i / STRTBL_GROUP_WIDTH; step++) {
+            group = (group + step) & groupMask;
+            probes++;
+        }
+        total += probes;
+    }
+    return numEntries > 0 ? (double)total / numEntries : 0;
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::allocate()
+//---------------------------------------------------------------------
+// empties the table into numSlots slots, a power of two.
+template <class Hash>
+void BasicStringTable<Hash>::allocate(size_t numSlots) {
+    control.assign(numSlots, EMPTY);
+    slots.assign(numSlots, NULL);
+    groupMask = numSlots / STRTBL_GROUP_WIDTH - 1;
+    growAt = numSlots / 8 * 7;
+    numCollisions = 0;
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::grow()
+//---------------------------------------------------------------------
+// doubles the slots and places every entry again by its stored hash;
+// the entries stay put.
+template <class Hash>
+void BasicStringTable<Hash>::grow() {
+    vector<signed char> oldControl;
+    vector<StringTableRef> oldSlots;
+    oldControl.swap(control);
+    oldSlots.swap(slots);
+    allocate(oldSlots.size() * 2);
+    for (size_t i = 0; i < oldSlots.size(); i++) {
+        if (oldControl[i] != EMPTY && place(hashOf(oldSlots[i]), oldSlots[i]) > 0) {
+            numCollisions += 1;
+        }
+    }
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::search()
+//---------------------------------------------------------------------
+template <class Hash>
+string BasicStringTable<Hash>::search(StringTableRef ref) {
+    if (ref) {
+        return string(ref->data());
+    }
+    else return "";
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::print()
+//---------------------------------------------------------------------
+template <class Hash>
+void BasicStringTable<Hash>::print() {
+    cout << "STRING TABLE:" << endl;
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (control[i] != EMPTY) {
+            cout << "[" << setw(4) << i << "]:\t" << slots[i]->data() << endl;
+        }
+    }
+    if (numEntries > 0) {
+    cout << "Collision Percentage: " << setprecision(2) <<
+        ((float)numCollisions/(float)numEntries)*PERCENTAGE_MULTIPLIER << "%" << endl;
+    }
+}
+//---------------------------------------------------------------------
+//                      BasicStringTable::destruct()
+//---------------------------------------------------------------------
+// drops every entry at once; the slot arrays and the arena's first chunk
+// are kept for reuse.
+template <class Hash>
+void BasicStringTable<Hash>::destruct() {
+    control.assign(control.size(), EMPTY);
+    arena.release();
+    numEntries = 0;
+    numCollisions = 0;
+}
+template class BasicStringTable<LegacyHash>;
+template class BasicStringTable<MurmurHash>;
+template class BasicStringTable<WideHash>;
+//---------------------------------------------------------------------
+//                      StringArena::~StringArena()
+//---------------------------------------------------------------------
+StringArena::~StringArena() {
+    release();
+    for (char *chunk : chunks) {
+        delete[] chunk;
+    }
+}
+//---------------------------------------------------------------------
+//                      StringArena::newChunk()
+//---------------------------------------------------------------------
+// returns the start of a new chunk holding bytes, which new[] aligns for
+// any entry. A request of over a quarter chunk gets a chunk to itself,
+// and the current one carries on.
+void *StringArena::newChunk(size_t bytes) {
+    if (bytes > STRTBL_ARENA_CHUNK / 4) {
+        char *chunk = new char[bytes];
+        chunks.push_back(chunk);
+        reservedBytes += bytes;
+        return chunk;
+    }
+    char *chunk = new char[STRTBL_ARENA_CHUNK];
+    chunks.push_back(chunk);
+    reservedBytes += STRTBL_ARENA_CHUNK;
+    current = chunk;
+    next = chunk + bytes;
+    end = chunk + STRTBL_ARENA_CHUNK;
+    return chunk;
+}
+//---------------------------------------------------------------------
+//                      StringArena::release()
+//---------------------------------------------------------------------
+void StringArena::release() {
+    for (char *chunk : chunks) {
+        if (chunk != current) {
+            delete[] chunk;
+        }
+    }
+    chunks.clear();
+    reservedBytes = 0;
+    next = current;
+    if (current != NULL) {
+        chunks.push_back(current);
+        reservedBytes = STRTBL_ARENA_CHUNK;
+    }
+}
+//---------------------------------------------------------------------
+//                      ChainedStringTable::ChainedStringTable
+//---------------------------------------------------------------------
+ChainedStringTable::ChainedStringTable() {
     for (size_t i = 0; i < STRTBL_NUM_BUCKETS; i++) {
         bucket[i] = NULL;
     }
 }
 //---------------------------------------------------------------------
-//                      StringTable::~StringTable()
+//                      ChainedStringTable::~ChainedStringTable()
 //---------------------------------------------------------------------
-StringTable::~StringTable() {
+ChainedStringTable::~ChainedStringTable() {
     destruct();
 }
 //---------------------------------------------------------------------
-//                      StringTable::insert()
+//                      ChainedStringTable::insert()
 //---------------------------------------------------------------------
-StringTableRef StringTable::insert(string item) {
-    StringTableRef insertedNode;
-    insertedNode = search(item);
+ChainedStringTable::Ref ChainedStringTable::insert(string item) {
+    StringHash h;
+    for (size_t i = 0; i < item.length(); i++) {
+        h.add(item[i]);
+    }
+    return insert(item, h);
+}
+//---------------------------------------------------------------------
+//                      ChainedStringTable::insert()
+//---------------------------------------------------------------------
+// item is copied only if it is new; h must be item's hash.
+ChainedStringTable::Ref ChainedStringTable::insert(string_view item, const StringHash &h) {
+    int hashVal = h.bucket();
+    Node* insertedNode = find(item, hashVal);
     if (insertedNode != NULL) { // string was found
         return insertedNode;
     }
     else {
-        (void)hash(item);
-        StringTableRef head = bucket[hashVal];
+        Node* head = bucket[hashVal];
         if (head == NULL) { // bucket is empty
-            head = new StringTableEntry;
+            head = new Node;
             head->data = item;
             bucket[hashVal] = head;
             insertedNode = head;
         }
         else {
-            StringTableRef tail = head;
+            Node* tail = head;
             while (tail->next != NULL) { // traverses past the end of the list
                 tail = tail->next;
             }
-            tail->next = new StringTableEntry;
+            tail->next = new Node;
             tail = tail->next;
             tail->data = item;
             insertedNode = tail;
@@ -54,18 +399,20 @@ StringTableRef StringTable::insert(string item) {
     return insertedNode;
 }
 //---------------------------------------------------------------------
-//                      StringTable::search()
+//                      ChainedStringTable::search()
 //---------------------------------------------------------------------
 // returns pointer to a StringTableEntry if found, otherwise returns NULL.
-StringTableRef StringTable::search(string searchName) {
-    StringTableRef current;
-    (void)hash(searchName);
-    current = bucket[hashVal];
-    if (current == NULL) { // not found
-        return NULL;
-    }
+ChainedStringTable::Ref ChainedStringTable::search(string searchName) {
+    return find(searchName, hash(searchName));
+}
+//---------------------------------------------------------------------
+//                      ChainedStringTable::find()
+//---------------------------------------------------------------------
+// looks for item in the bucket it hashes to.
+ChainedStringTable::Node* ChainedStringTable::find(string_view item, int hashVal) {
+    Node* current = bucket[hashVal];
     while (current != NULL) {
-        if (current->data == searchName) {
+        if (current->data == item) {
             return current;
         }
         else
@@ -74,21 +421,21 @@ StringTableRef StringTable::search(string searchName) {
     return NULL;
 }
 //---------------------------------------------------------------------
-//                      StringTable::search()
+//                      ChainedStringTable::search()
 //---------------------------------------------------------------------
-string StringTable::search(StringTableRef ref) {
+string ChainedStringTable::search(Ref ref) {
     if (ref) {
         return ref->data;
     }
     else return "";
 }
 //---------------------------------------------------------------------
-//                      StringTable::print()
+//                      ChainedStringTable::print()
 //---------------------------------------------------------------------
-void StringTable::print() {
+void ChainedStringTable::print() {
     cout << "STRING TABLE:" << endl;
     for (size_t i = 0; i < STRTBL_NUM_BUCKETS; i++) {
-        StringTableRef current = bucket[i];
+        Node* current = bucket[i];
         if (current != NULL) {
             cout << "[" << setw(4) << i << "]:\t" << bucket[i]->data << endl;
             current = current->next;
@@ -104,12 +451,12 @@ void StringTable::print() {
     }
 }
 //---------------------------------------------------------------------
-//                      StringTable::destruct()
+//                      ChainedStringTable::destruct()
 //---------------------------------------------------------------------
-void StringTable::destruct() {
+void ChainedStringTable::destruct() {
     for (size_t i = 0; i < STRTBL_NUM_BUCKETS; i++) {
-        StringTableRef head = bucket[i];
-        StringTableRef current;
+        Node* head = bucket[i];
+        Node* current;
         while (head != NULL) {
             current = head->next;
             delete head;
@@ -121,81 +468,22 @@ void StringTable::destruct() {
     numEntries = 0;
 }
 //---------------------------------------------------------------------
-//                      StringTable::hash()
+//                      ChainedStringTable::hash()
 //---------------------------------------------------------------------
-int StringTable::hash(string item) {
-	int seed = STRTBL_NUM_BUCKETS + RANDOMSEED; // helps make the table more random
-	// makes hash likely to be different for strings with differing chars,
-	// and guaranteed to be different for strings with 1 char.
+int ChainedStringTable::hash(string_view item) {
+	StringHash h;
 	for (size_t i = 0; i < item.length(); i++) {
-		seed += item[i];
-		seed *= item[i]; // helps spread distribution
+		h.add(item[i]);
 	}
-	// allows strings that are permutations of one another to be different.
-	// ex. abc, cba, bac
-	for (size_t i = 0; i < item.length(); i++) {
-		seed += (i+1) ^ item[i];
-	}
-	if (seed < 0) {
-		seed = -seed;
-	}
-    hashVal = seed % STRTBL_NUM_BUCKETS;
-	return hashVal;
+	return h.bucket();
 }
 //---------------------------------------------------------------------
-//                              name
+//                      StringHash::bucket()
 //---------------------------------------------------------------------
-int main(int argc, char** argv) {
-	{ // extra block to test the destructor
-		StringTable t;
-		string filename, aline, cmd;
-		char ccmd;
-		StringTableRef p;
-
-		// open the input file
-		if (argc < 2) return 0;
-		filename = argv[1];
-		ifstream f;
-		f.open(filename);
-		if (f.fail()) return 0;
-
-		// read test data and insert into string table, one line per item
-		while (!f.eof() && !f.fail()) {
-			getline(f, aline);
-			t.insert(aline);
-		}
-		f.close();
-		t.print();
-
-		ccmd = '?';
-		while (ccmd != 'X' && ccmd != 'E') {
-			cout << "Insert, Search, Print or Exit (I,S,P,X): ";
-			getline(cin, cmd);
-			ccmd = toupper(cmd[0]);
-			switch (ccmd) {
-			case 'I': cout << "Enter string: ";
-				getline(cin, aline);
-				t.insert(aline);
-				break;
-			case 'S': cout << "Enter string: ";
-				getline(cin, aline);
-				p = t.search(aline);
-				if (p) {
-					cout << "Found search 1: " << p->data << endl;
-					aline = t.search(p);
-					cout << "Found search 2: " << aline << endl;
-				}
-				else
-					cout << "Not found\n";
-				break;
-			case 'P': t.print(); break;
-			case 'X': cout << "Testing destruct...\n";
-				      t.destruct();
-					  t.print();
-					  break;
-			default:  cout << "Invalid input. Enter I,S,P or X\n";
-			}
-		}
+int StringHash::bucket() const {
+	unsigned int seed = mixed + positional;
+	if ((int)seed < 0) {
+		seed = -seed;
 	}
-	return 0;
+	return seed % STRTBL_NUM_BUCKETS;
 }
@@ -4,35 +4,207 @@
 // About: This program is an implementation of a string table designed
 // to have a relatively low collision rate.
 //---------------------------------------------------------------------
+#ifndef PROJ2_H
+#define PROJ2_H
+
+#include <concepts>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <vector>
 
 using namespace std;
 const int STRTBL_NUM_BUCKETS = 1000;
 const int PERCENTAGE_MULTIPLIER = 100;
 const int RANDOMSEED = 42938;
+const size_t STRTBL_GROUP_WIDTH = 16; // slots probed together
+const int STRTBL_GROUP_SHIFT = 32; // hash bits below a string's first group
+const size_t STRTBL_MIN_SLOTS = 64;
+const size_t STRTBL_ARENA_CHUNK = 64 * 1024;
 
-// a node in a linked list
+// an interned string; its address is the handle a table gives out, and
+// stays the same for the table's life however the table grows. The
+// record is a length and the top half of the string's hash, the bits
+// its slot is chosen by: the bytes follow it in the table's arena. The
+// hash lets a probe turn away a string whose tag matched by chance
+// without reading its bytes, and lets the table grow without hashing
+// every string again.
 struct StringTableEntry {
-	std::string data;
-	StringTableEntry* next = NULL;
+	uint32_t length;
+	uint32_t hashHigh;
+
+	string_view data() const { return string_view((const char *)(this + 1), length); }
+};
+typedef const StringTableEntry* StringTableRef;
+
+// Bump allocation from STRTBL_ARENA_CHUNK-byte chunks. Nothing is freed
+// on its own; release() drops every chunk at once but the current one,
+// which is kept for reuse.
+class StringArena {
+	public:
+		StringArena() {}
+		StringArena(const StringArena &) = delete;
+		StringArena &operator=(const StringArena &) = delete;
+		~StringArena();
+		void *allocate(size_t bytes, size_t align) {
+			size_t skip = (align - (uintptr_t)next % align) % align;
+			if (bytes + skip > (size_t)(end - next)) {
+				return newChunk(bytes);
+			}
+			void *p = next + skip;
+			next += skip + bytes;
+			return p;
+		}
+		void release();
+		size_t reserved() const { return reservedBytes; }
+	private:
+		vector<char *> chunks;
+		char *current = NULL; // the chunk being bumped through
+		char *next = NULL;
+		char *end = NULL;
+		size_t reservedBytes = 0;
+		void *newChunk(size_t bytes);
+};
+
+// The original table's hash, fed one character at a time. Arithmetic is
+// unsigned, so it wraps the way the old int version did in practice.
+struct StringHash {
+	unsigned int mixed = STRTBL_NUM_BUCKETS + RANDOMSEED;
+	unsigned int positional = 0;
+	unsigned int length = 0;
+
+	void add(char c) {
+		unsigned int u = (int)c;
+		mixed += u;
+		mixed *= u; // helps spread distribution
+		positional += ++length ^ u; // tells permutations apart
+	}
+	unsigned int value() const { return mixed + positional; }
+	int bucket() const;
+};
+
+// Hash policies for BasicStringTable. Each turns a string into 64 bits
+// that are well mixed all the way up, since the table takes its tags
+// from the top bits.
+//   LegacyHash - StringHash, a byte at a time, spread by a multiply
+//   MurmurHash - MurmurHash3_x64_128 from Hash/, its first 64 bits
+//   WideHash   - after wyhash: 8 bytes per step, each folded in by a
+//                64x64->128-bit multiply, and two multiplies in all for
+//                a name of 7 bytes or fewer
+struct LegacyHash {
+	static uint64_t hash(string_view item);
+};
+struct MurmurHash {
+	static uint64_t hash(string_view item);
+};
+// WideHash also hashes text that a caller reads itself, such as the
+// scanner as it finds an identifier's end: h = start(), then
+// h = step(h, word) for each whole 8 bytes from the front, loaded
+// little-endian, and finish(h, tail, length) with the 0 to 7 bytes
+// left over in tail's low bytes and the rest zero. The result is
+// hash() of the same text.
+struct WideHash {
+	static const uint64_t K0 = 0xa0761d6478bd642full;
+	static const uint64_t K1 = 0xe7037ed1a0b428dbull;
+
+	static uint64_t hash(string_view item);
+	// the 64x64->128-bit product's two halves xored together
+	static uint64_t fold(uint64_t a, uint64_t b) {
+		unsigned __int128 product = (unsigned __int128)a * b;
+		return (uint64_t)product ^ (uint64_t)(product >> 64);
+	}
+	static uint64_t start() { return RANDOMSEED ^ K0; }
+	static uint64_t step(uint64_t h, uint64_t word) { return fold(word ^ K1, h ^ K0); }
+	static uint64_t finish(uint64_t h, uint64_t tail, size_t length) {
+		return fold(K1 ^ length, fold(tail ^ K1, (tail << 32 | tail >> 32) ^ h));
+	}
+};
+
+// a policy that hashes text a word at a time, as WideHash does
+template <class Hash>
+concept IncrementalHash = requires(uint64_t h, uint64_t word, size_t length) {
+	{ Hash::start() } -> same_as<uint64_t>;
+	{ Hash::step(h, word) } -> same_as<uint64_t>;
+	{ Hash::finish(h, word, length) } -> same_as<uint64_t>;
 };
-typedef StringTableEntry* StringTableRef;
 
-class StringTable {
+// Open addressing in the style of Abseil's SwissTable. Each slot has a
+// control byte, EMPTY or the top 7 bits of its entry's hash, and slots
+// are probed STRTBL_GROUP_WIDTH at a time: one SSE2 compare of a
+// group's control bytes finds every slot whose tag matches, so a string
+// compare is only made when the entry's stored hash is equal too, and a
+// group with an EMPTY slot ends the search. Groups are visited in
+// triangular order. The slot array doubles before it is 7/8 full,
+// moving the slot pointers but not the entries, which live with their
+// bytes in an arena that destruct() empties in one step. Hash is one
+// of the policies above; the members are defined in proj2.cpp and
+// instantiated there for each of them.
+template <class Hash>
+class BasicStringTable {
 	public:
-		StringTable();
-		~StringTable();
-		StringTableRef insert(string item);
-		StringTableRef search(string searchName);
+		BasicStringTable();
+		~BasicStringTable();
+		typedef Hash hasher;
+
+		StringTableRef insert(string_view item);
+		// for a caller that has hashed item already; hashVal must be
+		// Hash::hash(item)
+		StringTableRef insert(string_view item, uint64_t hashVal);
+		StringTableRef search(string_view searchName);
 		string search(StringTableRef ref);
 		void print();
 		void destruct();
+		size_t size() const { return numEntries; }
+		int collisions() const { return numCollisions; }
+		double probeLength() const;
 	private:
-		StringTableRef bucket[STRTBL_NUM_BUCKETS];
-		int hash(string item);
-		int hashVal;
+		vector<signed char> control;
+		vector<StringTableRef> slots;
+		StringArena arena;
+		size_t numEntries = 0;
+		size_t groupMask = 0; // number of groups - 1
+		size_t growAt = 0; // entries that force the next doubling
+		int numCollisions = 0; // entries placed outside their first group
+		void allocate(size_t numSlots);
+		void grow();
+		size_t place(uint64_t hashVal, StringTableRef entry);
+		StringTableRef find(string_view item, uint64_t hashVal);
+};
+
+// WideHash hashes Proj2's test files' items about twice as fast as the
+// others and places them as well (Proj1/Bench/hashbench). Any policy
+// will do here; Proj1's scanner only hashes identifiers as it reads
+// them with an IncrementalHash, and otherwise hashes each word after.
+typedef BasicStringTable<WideHash> StringTable;
+
+// The original table: STRTBL_NUM_BUCKETS fixed chains of separately
+// allocated nodes. Kept for comparison with StringTable.
+class ChainedStringTable {
+	public:
+		// a node in a linked list
+		struct Node {
+			std::string data;
+			Node* next = NULL;
+		};
+		typedef Node* Ref;
+
+		ChainedStringTable();
+		~ChainedStringTable();
+		Ref insert(string item);
+		Ref insert(string_view item, const StringHash &h);
+		Ref search(string searchName);
+		string search(Ref ref);
+		void print();
+		void destruct();
+	private:
+		Node* bucket[STRTBL_NUM_BUCKETS];
+		int hash(string_view item);
+		Node* find(string_view item, int hashVal);
 		int numCollisions = 0;
 		int numEntries = 0;
 };
+
+#endif